@@ -0,0 +1,306 @@
+#include "BookingLog.h"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const size_t FRAME_HEADER_SIZE = 8;
+static const uint32_t MAX_RECORD_SIZE = 16 * 1024 * 1024;
+
+static void putUint32(string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back((char)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+static uint32_t readUint32(const string& data, size_t pos) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)(unsigned char)data[pos + i] << (8 * i);
+    }
+    return value;
+}
+
+// FNV-1a, enough to tell a torn write from a complete record
+static uint32_t checksum(const string& data, size_t pos, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = pos; i < pos + length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool syncFile(FILE* file) {
+    if (fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+static bool truncateFile(FILE* file, long size) {
+#ifdef _WIN32
+    return _chsize(_fileno(file), size) == 0;
+#else
+    return ftruncate(fileno(file), size) == 0;
+#endif
+}
+
+// BookingLogRecord class implementation
+BookingLogRecord::BookingLogRecord(uint8_t type) {
+    payload.push_back((char)type);
+}
+
+void BookingLogRecord::putInt(int64_t value) {
+    uint64_t bits = (uint64_t)value;
+    for (int i = 0; i < 8; i++) {
+        payload.push_back((char)((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+void BookingLogRecord::putDouble(double value) {
+    int64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putInt(bits);
+}
+
+void BookingLogRecord::putString(const string& value) {
+    putInt((int64_t)value.size());
+    payload += value;
+}
+
+void BookingLogRecord::putStrings(const vector<string>& values) {
+    putInt((int64_t)values.size());
+    for (const string& value : values) {
+        putString(value);
+    }
+}
+
+// BookingLogReader class implementation
+BookingLogReader::BookingLogReader(const string& recordPayload)
+    : payload(recordPayload), pos(0), ok(true) {}
+
+uint8_t BookingLogReader::getType() {
+    if (pos >= payload.size()) {
+        ok = false;
+        return 0;
+    }
+    return (uint8_t)payload[pos++];
+}
+
+int64_t BookingLogReader::getInt() {
+    if (pos + 8 > payload.size()) {
+        ok = false;
+        return 0;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits |= (uint64_t)(unsigned char)payload[pos + i] << (8 * i);
+    }
+    pos += 8;
+    return (int64_t)bits;
+}
+
+double BookingLogReader::getDouble() {
+    int64_t bits = getInt();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+string BookingLogReader::getString() {
+    int64_t length = getInt();
+    if (!ok || length < 0 || (uint64_t)length > payload.size() - pos) {
+        ok = false;
+        return "";
+    }
+    string value = payload.substr(pos, (size_t)length);
+    pos += (size_t)length;
+    return value;
+}
+
+vector<string> BookingLogReader::getStrings() {
+    vector<string> values;
+    int64_t count = getInt();
+    if (!ok || count < 0 || (uint64_t)count > payload.size() - pos) {
+        ok = false;
+        return values;
+    }
+    for (int64_t i = 0; i < count && ok; i++) {
+        values.push_back(getString());
+    }
+    return values;
+}
+
+// BookingLog class implementation
+BookingLog::BookingLog()
+    : file(nullptr), group_commit(true), appended_lsn(0), durable_lsn(0),
+      flushing(false), failed(false), good_size(0), sync_count(0) {}
+
+BookingLog::~BookingLog() {
+    close();
+}
+
+bool BookingLog::readRecords(const string& path, vector<string>& payloads, string& error) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+        return true; // No log yet
+    }
+
+    stringstream buffer;
+    buffer << in.rdbuf();
+    string data = buffer.str();
+    in.close();
+
+    size_t pos = 0;
+    while (pos + FRAME_HEADER_SIZE <= data.size()) {
+        uint32_t length = readUint32(data, pos);
+        if (length == 0 || length > MAX_RECORD_SIZE || pos + FRAME_HEADER_SIZE + length > data.size() ||
+            checksum(data, pos + FRAME_HEADER_SIZE, length) != readUint32(data, pos + 4)) {
+            break;
+        }
+        payloads.push_back(data.substr(pos + FRAME_HEADER_SIZE, length));
+        pos += FRAME_HEADER_SIZE + length;
+    }
+
+    // Drop the torn tail so records appended from now on stay readable
+    if (pos < data.size()) {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out.is_open() || !out.write(data.data(), pos)) {
+            error = "Cannot repair booking log " + path;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BookingLog::open(const string& path, bool groupCommit, string& error) {
+    close();
+
+    lock_guard<mutex> guard(lock);
+    file = fopen(path.c_str(), "ab");
+    if (!file) {
+        error = "Cannot open booking log " + path;
+        return false;
+    }
+    // Unbuffered, so a failed write leaves nothing behind for fclose to flush
+    setvbuf(file, nullptr, _IONBF, 0);
+    fseek(file, 0, SEEK_END);
+    good_size = ftell(file);
+    group_commit = groupCommit;
+    pending.clear();
+    appended_lsn = 0;
+    durable_lsn = 0;
+    failed = false;
+    sync_count = 0;
+    return true;
+}
+
+void BookingLog::close() {
+    unique_lock<mutex> guard(lock);
+    flushed.wait(guard, [this] { return !flushing; });
+    if (file) {
+        if (!pending.empty() && !failed) {
+            writeAndSync(pending);
+            pending.clear();
+        }
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+bool BookingLog::isOpen() const {
+    lock_guard<mutex> guard(lock);
+    return file != nullptr;
+}
+
+long BookingLog::getSyncCount() const {
+    lock_guard<mutex> guard(lock);
+    return sync_count;
+}
+
+bool BookingLog::writeAndSync(const string& data) {
+    if (failed) {
+        return false;
+    }
+    if (fwrite(data.data(), 1, data.size(), file) != data.size() || !syncFile(file)) {
+        discardTail();
+        return false;
+    }
+    good_size += (long)data.size();
+    sync_count++;
+    return true;
+}
+
+// After a failed write nothing more is written: later records would land after a hole
+// or a torn frame. Cut the file back to its last whole frame so recovery reads it all.
+void BookingLog::discardTail() {
+    failed = true;
+    pending.clear();
+    truncateFile(file, good_size);
+}
+
+uint64_t BookingLog::append(const BookingLogRecord& record) {
+    const string& payload = record.getPayload();
+    string frame;
+    frame.reserve(FRAME_HEADER_SIZE + payload.size());
+    putUint32(frame, (uint32_t)payload.size());
+    putUint32(frame, checksum(payload, 0, payload.size()));
+    frame += payload;
+
+    lock_guard<mutex> guard(lock);
+    if (!file) {
+        return 0;
+    }
+
+    uint64_t lsn = ++appended_lsn;
+    if (failed) {
+        return lsn; // commit reports the failure
+    } else if (group_commit) {
+        pending += frame;
+    } else if (writeAndSync(frame)) {
+        durable_lsn = lsn; // fsync per operation
+    }
+    return lsn;
+}
+
+// Group commit: the first committer becomes the leader and syncs everything appended so
+// far; committers arriving meanwhile wait and are usually covered by the next batch
+bool BookingLog::commit(uint64_t lsn) {
+    unique_lock<mutex> guard(lock);
+    while (durable_lsn < lsn && !failed) {
+        if (flushing) {
+            flushed.wait(guard);
+            continue;
+        }
+
+        flushing = true;
+        string batch;
+        batch.swap(pending);
+        uint64_t batchLsn = appended_lsn;
+
+        guard.unlock();
+        bool written = fwrite(batch.data(), 1, batch.size(), file) == batch.size() && syncFile(file);
+        guard.lock();
+
+        if (written) {
+            durable_lsn = batchLsn;
+            good_size += (long)batch.size();
+            sync_count++;
+        } else {
+            discardTail();
+        }
+        flushing = false;
+        flushed.notify_all();
+    }
+    return durable_lsn >= lsn; // never past a failed write
+}
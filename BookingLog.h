@@ -0,0 +1,100 @@
+#ifndef BOOKINGLOG_H
+#define BOOKINGLOG_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// One log record: a type byte followed by little-endian fields
+class BookingLogRecord {
+private:
+    string payload;
+
+public:
+    explicit BookingLogRecord(uint8_t type);
+
+    const string& getPayload() const { return payload; }
+
+    void putInt(int64_t value);
+    void putDouble(double value);
+    void putString(const string& value);
+    void putStrings(const vector<string>& values);
+};
+
+// Reads the fields of a record back in the order they were written
+class BookingLogReader {
+private:
+    const string& payload;
+    size_t pos;
+    bool ok;
+
+public:
+    explicit BookingLogReader(const string& recordPayload);
+
+    bool isOk() const { return ok; }
+
+    uint8_t getType();
+    int64_t getInt();
+    double getDouble();
+    string getString();
+    vector<string> getStrings();
+};
+
+// BookingLog - append-only write-ahead log of booking mutations
+// Frame: [uint32 payload length][uint32 checksum][payload]. A torn or corrupt tail
+// (crash mid-write) ends recovery and is cut off before new records are appended.
+class BookingLog {
+public:
+    // Record types
+    static const uint8_t HOLD_SEATS = 1;
+    static const uint8_t RELEASE_SEATS = 2;
+    static const uint8_t CREATE_ORDER = 3;
+    static const uint8_t UPDATE_ORDER = 4;
+    static const uint8_t CONFIRM_BOOKING = 5;
+    static const uint8_t CANCEL_BOOKING = 6;
+    static const uint8_t EXCHANGE_TICKET = 7;
+    static const uint8_t REFUND_TICKET = 8;
+    static const uint8_t ISSUE_TICKETS = 9;
+
+private:
+    FILE* file;
+    bool group_commit;
+    string pending; // Framed records not yet written
+    uint64_t appended_lsn; // Records appended so far
+    uint64_t durable_lsn; // Records known to be on disk
+    bool flushing; // A leader is writing and syncing a batch
+    bool failed; // Sticky: once a write fails the log refuses further records
+    long good_size; // Bytes of whole, synced frames in the file
+    long sync_count;
+    mutable mutex lock;
+    condition_variable flushed;
+
+    bool writeAndSync(const string& data);
+    void discardTail();
+
+public:
+    BookingLog();
+    ~BookingLog();
+
+    // Returns the payloads of every intact record and repairs a torn tail
+    static bool readRecords(const string& path, vector<string>& payloads, string& error);
+
+    bool open(const string& path, bool groupCommit, string& error);
+    void close();
+    bool isOpen() const;
+    bool isGroupCommit() const { return group_commit; }
+    long getSyncCount() const;
+
+    // append is cheap and may be called under the caller's locks; commit blocks until the
+    // record is durable and must be called without them so concurrent commits share one fsync.
+    // After a failed write every later commit returns false.
+    uint64_t append(const BookingLogRecord& record);
+    bool commit(uint64_t lsn);
+};
+
+#endif
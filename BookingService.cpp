@@ -1,27 +1,82 @@
 #include "BookingService.h"
+#include "PaymentService.h"
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
 #include <cstring>
+#include <bitset>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <cstdio>
+
+// Statuses
+const char* toString(SeatStatus status) {
+    switch (status) {
+        case SeatStatus::AVAILABLE: return "available";
+        case SeatStatus::HELD: return "held";
+        case SeatStatus::SOLD: return "sold";
+    }
+    return "unknown";
+}
+
+const char* toString(OrderPaymentStatus status) {
+    switch (status) {
+        case OrderPaymentStatus::PENDING: return "pending";
+        case OrderPaymentStatus::PAID: return "paid";
+        case OrderPaymentStatus::CANCELED: return "canceled";
+        case OrderPaymentStatus::REFUNDED: return "refunded";
+    }
+    return "unknown";
+}
+
+const char* toString(TicketStatus status) {
+    switch (status) {
+        case TicketStatus::VALID: return "valid";
+        case TicketStatus::USED: return "used";
+        case TicketStatus::CANCELED: return "canceled";
+    }
+    return "unknown";
+}
+
+bool parseStatus(const string& text, OrderPaymentStatus& status) {
+    string name = text;
+    transform(name.begin(), name.end(), name.begin(), ::tolower);
+    for (OrderPaymentStatus candidate : {OrderPaymentStatus::PENDING, OrderPaymentStatus::PAID, 
+                                         OrderPaymentStatus::CANCELED, OrderPaymentStatus::REFUNDED}) {
+        if (name == toString(candidate)) {
+            status = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool canTransition(SeatStatus from, SeatStatus to) {
+    return from != to && !(from == SeatStatus::SOLD && to == SeatStatus::HELD);
+}
+
+bool canTransition(OrderPaymentStatus from, OrderPaymentStatus to) {
+    switch (from) {
+        case OrderPaymentStatus::PENDING: return to == OrderPaymentStatus::PAID || to == OrderPaymentStatus::CANCELED;
+        case OrderPaymentStatus::PAID: return to == OrderPaymentStatus::REFUNDED;
+        default: return false;
+    }
+}
+
+bool canTransition(TicketStatus from, TicketStatus to) {
+    return from == TicketStatus::VALID && to != TicketStatus::VALID;
+}
 
 // Seat class implementation
 Seat::Seat() : seat_id(""), row(""), number(0), type("Standard"), 
-               status("available"), hold_expires_at(0), order_id(0), price_multiplier(1.0) {}
+               status(SeatStatus::AVAILABLE), hold_expires_at(0), order_id(0), price_multiplier(1.0) {}
 
 Seat::Seat(const string& seatId, const string& seatType) 
-    : seat_id(seatId), type(seatType), status("available"), 
-      hold_expires_at(0), order_id(0), price_multiplier(1.0) {
+    : seat_id(seatId), type(seatType), status(SeatStatus::AVAILABLE), 
+      hold_expires_at(0), order_id(0), price_multiplier(SeatLayout::defaultPriceMultiplier(seatType)) {
     setSeatId(seatId);
-    
-    // Set price multiplier based on seat type
-    if (type == "VIP") {
-        price_multiplier = 1.5;
-    } else if (type == "Couple") {
-        price_multiplier = 1.3;
-    } else if (type == "Premium") {
-        price_multiplier = 1.8;
-    }
 }
 
 void Seat::setSeatId(const string& newSeatId) {
@@ -36,485 +91,2298 @@ void Seat::setSeatId(const string& newSeatId) {
     }
 }
 
+bool Seat::setStatus(SeatStatus newStatus) {
+    if (!canTransition(status, newStatus)) {
+        return false;
+    }
+    status = newStatus;
+    return true;
+}
+
 bool Seat::isAvailable() const {
-    return status == "available";
+    return status == SeatStatus::AVAILABLE;
 }
 
 bool Seat::isHeld() const {
-    return status == "held" && !isHoldExpired();
+    return isHeld(TimeService::now());
+}
+
+bool Seat::isHeld(time_t now) const {
+    return status == SeatStatus::HELD && !isHoldExpired(now);
 }
 
 bool Seat::isSold() const {
-    return status == "sold";
+    return status == SeatStatus::SOLD;
 }
 
 bool Seat::isHoldExpired() const {
-    return status == "held" && time(0) > hold_expires_at;
+    return isHoldExpired(TimeService::now());
+}
+
+bool Seat::isHoldExpired(time_t now) const {
+    return status == SeatStatus::HELD && now > hold_expires_at;
 }
 
 void Seat::displayInfo() const {
-    cout << seat_id << "(" << type << "): " << status;
-    if (status == "held") {
-        cout << " [expires in " << (hold_expires_at - time(0)) << "s]";
+    cout << seat_id << "(" << type << "): " << toString(status);
+    if (status == SeatStatus::HELD) {
+        cout << " [expires in " << (hold_expires_at - TimeService::now()) << "s]";
     }
 }
 
-// Order class implementation
-Order::Order() : id(0), staff_id(0), showtime_id(0), subtotal(0.0), tax(0.0), 
-                 discount(0.0), total_amount(0.0), payment_status("pending"),
-                 created_at(time(0)), updated_at(time(0)) {}
+// SeatLayout class implementation
+void SeatLayout::addRow(const string& label, int offset) {
+    row_starts.push_back((int)seat_ids.size());
+    row_labels.push_back(label);
+    row_adjacency.push_back(0);
+    for (auto& typeMasks : row_type_masks) {
+        typeMasks.push_back(0);
+    }
+    next_column = offset;
+}
 
-Order::Order(int staffId, int showtimeId, const vector<string>& seatIds)
-    : id(0), staff_id(staffId), showtime_id(showtimeId), seat_ids(seatIds),
-      subtotal(0.0), tax(0.0), discount(0.0), total_amount(0.0), 
-      payment_status("pending"), created_at(time(0)), updated_at(time(0)) {}
+int SeatLayout::addSeat(const string& seatId, const string& seatType, int column) {
+    int ordinal = (int)seat_ids.size();
+    if (row_starts.empty()) {
+        addRow(seatId.substr(0, 1));
+    } else if (ordinal - row_starts.back() == 64) {
+        addRow(row_labels.back(), next_column); // Continue an overlong row in a new word
+    }
+    if (column < 0) {
+        column = next_column;
+    }
+    
+    int seatInRow = ordinal - row_starts.back();
+    if (seatInRow > 0 && columns.back() + 1 == column) {
+        row_adjacency.back() |= 1ULL << (seatInRow - 1);
+    }
+    
+    size_t typeCode = find(type_names.begin(), type_names.end(), seatType) - type_names.begin();
+    if (typeCode == type_names.size()) {
+        type_names.push_back(seatType);
+        type_price_multipliers.push_back(defaultPriceMultiplier(seatType));
+        row_type_masks.push_back(vector<uint64_t>(row_starts.size(), 0));
+    }
+    row_type_masks[typeCode].back() |= 1ULL << seatInRow;
+    
+    seat_ids.push_back(seatId);
+    type_codes.push_back((uint8_t)typeCode);
+    columns.push_back((uint8_t)column);
+    ordinals[seatId] = ordinal;
+    next_column = column + 1;
+    return ordinal;
+}
 
-void Order::calculateTotal() {
-    total_amount = subtotal + tax - discount;
-    updated_at = time(0);
+int SeatLayout::findOrdinal(const string& seatId) const {
+    auto it = ordinals.find(seatId);
+    return it != ordinals.end() ? it->second : -1;
 }
 
-void Order::displayInfo() const {
-    cout << "Order ID: " << id << " | Staff: " << staff_id 
-         << " | Showtime: " << showtime_id << " | Seats: ";
-    for (const auto& seat : seat_ids) {
-        cout << seat << " ";
+double SeatLayout::defaultPriceMultiplier(const string& seatType) {
+    if (seatType == "VIP") {
+        return 1.5;
+    } else if (seatType == "Couple") {
+        return 1.3;
+    } else if (seatType == "Premium") {
+        return 1.8;
     }
-    cout << endl;
-    cout << "Subtotal: $" << subtotal << " | Tax: $" << tax 
-         << " | Discount: $" << discount << " | Total: $" << total_amount << endl;
-    cout << "Status: " << payment_status << " | Customer: " << customer_name 
-         << " | Phone: " << customer_phone << endl;
+    return 1.0;
 }
 
-bool Order::isValid() const {
-    return staff_id > 0 && showtime_id > 0 && !seat_ids.empty() && total_amount >= 0;
+int SeatLayout::getRowEnd(int rowIndex) const {
+    if (rowIndex + 1 < (int)row_starts.size()) {
+        return row_starts[rowIndex + 1];
+    }
+    return (int)seat_ids.size();
 }
 
-// Ticket class implementation
-Ticket::Ticket() : ticket_id(""), order_id(0), showtime_id(0), seat_id(""),
-                   show_time(0), price(0.0), status("valid"), issued_at(time(0)) {}
-
-Ticket::Ticket(int orderId, int showtimeId, const string& seatId)
-    : order_id(orderId), showtime_id(showtimeId), seat_id(seatId),
-      show_time(0), price(0.0), status("valid"), issued_at(time(0)) {
-    ticket_id = generateTicketId();
+uint64_t SeatLayout::getRowTypeMask(int rowIndex, const string& seatType) const {
+    size_t typeCode = find(type_names.begin(), type_names.end(), seatType) - type_names.begin();
+    if (typeCode == type_names.size()) {
+        return 0;
+    }
+    return row_type_masks[typeCode][rowIndex];
 }
 
-void Ticket::displayTicket() const {
-    cout << "\n========== CINEMA TICKET ==========" << endl;
-    cout << "Ticket ID: " << ticket_id << endl;
-    cout << "Movie: " << movie_title << endl;
-    cout << "Auditorium: " << auditorium_name << endl;
-    cout << "Seat: " << seat_id << endl;
+// SeatMapCompiler class implementation
+// Minimal JSON reader for the seat map format, positions are reported in error messages
+class SeatMapJsonReader {
+private:
+    const string& text;
+    size_t pos;
+
+public:
+    explicit SeatMapJsonReader(const string& json) : text(json), pos(0) {}
     
-    char timeBuffer[80];
-    strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M", localtime(&show_time));
-    cout << "Show Time: " << timeBuffer << endl;
+    void skipSpace() {
+        while (pos < text.size() && isspace((unsigned char)text[pos])) pos++;
+    }
     
-    cout << "Price: $" << fixed << setprecision(2) << price << endl;
-    cout << "Status: " << status << endl;
+    bool consume(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
     
-    strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M", localtime(&issued_at));
-    cout << "Issued: " << timeBuffer << endl;
-    cout << "===================================" << endl;
+    bool peek(char c) {
+        skipSpace();
+        return pos < text.size() && text[pos] == c;
+    }
+    
+    bool readString(string& value) {
+        if (!consume('"')) return false;
+        value.clear();
+        while (pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\' && pos + 1 < text.size()) pos++;
+            value += text[pos++];
+        }
+        return consume('"');
+    }
+    
+    bool readInt(int& value) {
+        skipSpace();
+        size_t start = pos;
+        if (pos < text.size() && text[pos] == '-') pos++;
+        while (pos < text.size() && isdigit((unsigned char)text[pos])) pos++;
+        if (pos == start) return false;
+        value = atoi(text.substr(start, pos - start).c_str());
+        return true;
+    }
+    
+    // Skips any JSON value (used for keys the compiler does not know)
+    bool skipValue() {
+        skipSpace();
+        if (peek('"')) {
+            string ignored;
+            return readString(ignored);
+        }
+        if (consume('{') || consume('[')) {
+            int depth = 1;
+            while (pos < text.size() && depth > 0) {
+                if (text[pos] == '"') {
+                    string ignored;
+                    if (!readString(ignored)) return false;
+                    continue;
+                }
+                if (text[pos] == '{' || text[pos] == '[') depth++;
+                if (text[pos] == '}' || text[pos] == ']') depth--;
+                pos++;
+            }
+            return depth == 0;
+        }
+        size_t start = pos;
+        while (pos < text.size() && (isalnum((unsigned char)text[pos]) || text[pos] == '.' || 
+                                     text[pos] == '-' || text[pos] == '+')) pos++;
+        return pos > start;
+    }
+    
+    size_t getPosition() const { return pos; }
+};
+
+static const char* seatTypeForCode(char code) {
+    switch (code) {
+        case 'S': return "Standard";
+        case 'V': return "VIP";
+        case 'C': return "Couple";
+        case 'P': return "Premium";
+        case 'W': return "Wheelchair";
+        default: return nullptr;
+    }
 }
 
-string Ticket::generateTicketId() const {
-    stringstream ss;
-    ss << "TKT" << setfill('0') << setw(6) << (order_id * 1000 + rand() % 1000);
-    return ss.str();
+shared_ptr<const SeatLayout> SeatMapCompiler::compile(const string& seatMapJson, string& error) {
+    shared_ptr<SeatLayout> layout = make_shared<SeatLayout>();
+    SeatMapJsonReader reader(seatMapJson);
+    
+    auto fail = [&error, &reader](const string& message) {
+        stringstream ss;
+        ss << message << " at position " << reader.getPosition();
+        error = ss.str();
+        return shared_ptr<const SeatLayout>();
+    };
+    
+    if (!reader.consume('{')) return fail("Expected '{'");
+    
+    bool hasRows = false;
+    while (!reader.consume('}')) {
+        string key;
+        if (!reader.readString(key) || !reader.consume(':')) return fail("Expected key");
+        
+        if (key != "rows") {
+            if (!reader.skipValue()) return fail("Invalid value");
+        } else {
+            hasRows = true;
+            if (!reader.consume('[')) return fail("Expected '['");
+            
+            while (!reader.consume(']')) {
+                string label;
+                string seats;
+                int offset = 0;
+                
+                if (!reader.consume('{')) return fail("Expected row object");
+                while (!reader.consume('}')) {
+                    string rowKey;
+                    if (!reader.readString(rowKey) || !reader.consume(':')) return fail("Expected row key");
+                    
+                    bool ok;
+                    if (rowKey == "label") ok = reader.readString(label);
+                    else if (rowKey == "seats") ok = reader.readString(seats);
+                    else if (rowKey == "offset") ok = reader.readInt(offset);
+                    else ok = reader.skipValue();
+                    if (!ok) return fail("Invalid value for '" + rowKey + "'");
+                    
+                    reader.consume(',');
+                }
+                
+                if (label.empty()) return fail("Row without label");
+                if (offset < 0 || offset + seats.size() > 255) return fail("Row " + label + " is too wide");
+                
+                layout->addRow(label, offset);
+                int seatNumber = 0;
+                for (size_t i = 0; i < seats.size(); i++) {
+                    if (seats[i] == '_' || seats[i] == ' ') {
+                        continue; // Aisle or gap: the column stays empty
+                    }
+                    const char* seatType = seatTypeForCode(seats[i]);
+                    if (!seatType) return fail("Unknown seat code '" + string(1, seats[i]) + "' in row " + label);
+                    
+                    stringstream seatId;
+                    seatId << label << setfill('0') << setw(2) << ++seatNumber;
+                    if (layout->findOrdinal(seatId.str()) >= 0) return fail("Duplicate seat " + seatId.str());
+                    layout->addSeat(seatId.str(), seatType, offset + (int)i);
+                }
+                
+                reader.consume(',');
+            }
+        }
+        reader.consume(',');
+    }
+    
+    if (!hasRows || layout->getSeatCount() == 0) return fail("Seat map has no seats");
+    return layout;
 }
 
-bool Ticket::isValid() const {
-    return !ticket_id.empty() && order_id > 0 && showtime_id > 0 && 
-           !seat_id.empty() && status == "valid";
+// SeatStateMap class implementation
+static int lowestBitIndex(uint64_t word) {
+    return (int)bitset<64>((word & (~word + 1)) - 1).count();
 }
 
-// BookingService class implementation
-BookingService::BookingService() : nextOrderId(1), nextTicketId(1) {
-    // Initialize sample seat maps for showtimes
-    initializeSeatsForShowtime(1, 100); // Showtime 1 with 100 seats
-    initializeSeatsForShowtime(2, 150); // Showtime 2 with 150 seats
+static int highestBitIndex(uint64_t word) {
+    word |= word >> 1;
+    word |= word >> 2;
+    word |= word >> 4;
+    word |= word >> 8;
+    word |= word >> 16;
+    word |= word >> 32;
+    return (int)bitset<64>(word).count() - 1;
 }
 
-bool BookingService::validateSeatSelection(int showtimeId, const vector<string>& seatIds) const {
-    if (seatIds.empty()) {
-        cout << "Error: No seats selected!" << endl;
-        return false;
+// Bit j of the result is set when bits j..j+count-1 of freeMask are all set and
+// each neighbouring pair is adjacent (adjacency bit i links seat i and seat i+1)
+static uint64_t blockStartMask(uint64_t freeMask, uint64_t adjacency, int count) {
+    if (count == 1) {
+        return freeMask;
     }
     
-    // Check if showtime exists
-    if (showtimeSeats.find(showtimeId) == showtimeSeats.end()) {
-        cout << "Error: Showtime not found!" << endl;
-        return false;
+    uint64_t starts = freeMask & adjacency & (freeMask >> 1); // Blocks of two
+    int covered = 2;
+    while (covered < count) {
+        // Windows overlap by at least one seat, so every neighbouring pair stays covered
+        int step = min(covered - 1, count - covered);
+        starts &= starts >> step;
+        covered += step;
+    }
+    return starts;
+}
+
+SeatStateMap::SeatStateMap() : layout(make_shared<SeatLayout>()), hold_timeout_seconds(300) {}
+
+SeatStateMap::SeatStateMap(const shared_ptr<const SeatLayout>& seatLayout, int holdTimeoutSeconds)
+    : layout(seatLayout), hold_timeout_seconds(holdTimeoutSeconds) {}
+
+void SeatStateMap::allocateState() {
+    if (hasState()) {
+        return;
     }
     
-    // Check if all seats are valid and available
-    const vector<Seat>& seats = showtimeSeats.at(showtimeId);
-    for (const string& seatId : seatIds) {
-        bool found = false;
-        for (const Seat& seat : seats) {
-            if (seat.getSeatId() == seatId) {
-                found = true;
-                if (!seat.isAvailable()) {
-                    cout << "Error: Seat " << seatId << " is not available!" << endl;
-                    return false;
-                }
-                break;
-            }
-        }
-        if (!found) {
-            cout << "Error: Seat " << seatId << " does not exist!" << endl;
-            return false;
-        }
+    int seatCount = getSeatCount();
+    int wordCount = getWordCount();
+    
+    available_bits.assign(wordCount, ~0ULL);
+    held_bits.assign(wordCount, 0);
+    sold_bits.assign(wordCount, 0);
+    if (seatCount % 64 != 0) {
+        available_bits.back() = (1ULL << (seatCount % 64)) - 1; // No bits past the last seat
     }
     
-    return true;
+    hold_expires_at.assign(seatCount, 0);
+    order_ids.assign(seatCount, 0);
 }
 
-double BookingService::calculateSeatPrice(const string& seatId, double basePrice) const {
-    // Find seat type and apply multiplier
-    // This is a simplified implementation
-    if (seatId.find("V") != string::npos) { // VIP seats contain 'V'
-        return basePrice * 1.5;
-    } else if (seatId.find("C") != string::npos) { // Couple seats contain 'C'
-        return basePrice * 1.3;
+int SeatStateMap::countBits(const vector<uint64_t>& plane) {
+    int count = 0;
+    for (uint64_t word : plane) {
+        count += (int)bitset<64>(word).count();
     }
-    return basePrice; // Standard price
+    return count;
 }
 
-void BookingService::initializeSeatsForShowtime(int showtimeId, int totalSeats) {
-    vector<Seat> seats;
-    
-    // Generate seat layout (simplified)
-    int seatsPerRow = 10;
-    int rows = (totalSeats + seatsPerRow - 1) / seatsPerRow;
+bool SeatStateMap::buildMask(const vector<string>& seatIds, vector<uint64_t>& mask, string& unknownSeatId) const {
+    mask.assign(getWordCount(), 0);
+    bool allKnown = true;
     
-    for (int row = 0; row < rows; row++) {
-        char rowLetter = 'A' + row;
-        for (int seatNum = 1; seatNum <= seatsPerRow && seats.size() < totalSeats; seatNum++) {
-            stringstream ss;
-            ss << rowLetter << setfill('0') << setw(2) << seatNum;
-            string seatId = ss.str();
-            
-            string seatType = "Standard";
-            if (row >= rows - 2) { // Last 2 rows are VIP
-                seatType = "VIP";
-            } else if (seatNum == 5 || seatNum == 6) { // Middle seats are couple seats
-                seatType = "Couple";
+    for (const string& seatId : seatIds) {
+        int ordinal = layout->findOrdinal(seatId);
+        if (ordinal < 0) {
+            if (allKnown) {
+                unknownSeatId = seatId;
             }
-            
-            Seat seat(seatId, seatType);
-            seats.push_back(seat);
+            allKnown = false;
+            continue;
         }
+        mask[ordinal >> 6] |= 1ULL << (ordinal & 63);
     }
     
-    showtimeSeats[showtimeId] = seats;
+    return allKnown;
 }
 
-// Heap sort implementation for seats
-vector<Seat> BookingService::heapSortSeats(vector<Seat> seatList, bool byPrice) const {
-    make_heap(seatList.begin(), seatList.end(), [byPrice](const Seat& a, const Seat& b) {
-        if (byPrice) {
-            return a.getPriceMultiplier() < b.getPriceMultiplier();
-        }
-        return a.getSeatId() > b.getSeatId(); // Sort by seat ID
-    });
+int SeatStateMap::firstUnavailable(const vector<uint64_t>& mask) const {
+    if (!hasState()) {
+        return -1;
+    }
     
-    sort_heap(seatList.begin(), seatList.end(), [byPrice](const Seat& a, const Seat& b) {
-        if (byPrice) {
-            return a.getPriceMultiplier() < b.getPriceMultiplier();
+    for (size_t w = 0; w < mask.size(); w++) {
+        uint64_t blocked = mask[w] & ~available_bits[w];
+        if (blocked) {
+            return (int)w * 64 + lowestBitIndex(blocked);
         }
-        return a.getSeatId() > b.getSeatId();
-    });
-    
-    return seatList;
+    }
+    return -1;
 }
 
-vector<Seat> BookingService::getSeatsForShowtime(int showtimeId) {
-    if (showtimeSeats.find(showtimeId) == showtimeSeats.end()) {
-        initializeSeatsForShowtime(showtimeId, 100); // Default 100 seats
+void SeatStateMap::hold(const vector<uint64_t>& mask, time_t expiresAt, int orderId) {
+    allocateState();
+    for (size_t w = 0; w < mask.size(); w++) {
+        uint64_t bits = mask[w] & available_bits[w];
+        available_bits[w] &= ~bits;
+        held_bits[w] |= bits;
+        
+        for (; bits; bits &= bits - 1) {
+            int ordinal = (int)w * 64 + lowestBitIndex(bits);
+            hold_expires_at[ordinal] = expiresAt;
+            order_ids[ordinal] = orderId;
+        }
     }
-    return showtimeSeats[showtimeId];
 }
 
-bool BookingService::holdSeats(int showtimeId, const vector<string>& seatIds, int holdTimeMinutes) {
-    if (!validateSeatSelection(showtimeId, seatIds)) {
-        return false;
+int SeatStateMap::releaseHeld(const vector<uint64_t>& mask, int orderId) {
+    if (!hasState()) {
+        return 0;
     }
     
-    vector<Seat>& seats = showtimeSeats[showtimeId];
-    time_t holdExpiry = time(0) + holdTimeMinutes * 60;
-    
-    for (const string& seatId : seatIds) {
-        for (Seat& seat : seats) {
-            if (seat.getSeatId() == seatId) {
-                seat.setStatus("held");
-                seat.setHoldExpiresAt(holdExpiry);
-                break;
+    int released = 0;
+    for (size_t w = 0; w < mask.size(); w++) {
+        for (uint64_t bits = mask[w] & held_bits[w]; bits; bits &= bits - 1) {
+            int ordinal = (int)w * 64 + lowestBitIndex(bits);
+            if (order_ids[ordinal] == orderId) {
+                uint64_t bit = 1ULL << (ordinal & 63);
+                held_bits[w] &= ~bit;
+                available_bits[w] |= bit;
+                hold_expires_at[ordinal] = 0;
+                order_ids[ordinal] = 0;
+                released++;
             }
         }
     }
-    
-    cout << "Seats held for " << holdTimeMinutes << " minutes." << endl;
-    return true;
+    return released;
 }
 
-bool BookingService::releaseHeldSeats(int showtimeId, const vector<string>& seatIds) {
-    if (showtimeSeats.find(showtimeId) == showtimeSeats.end()) {
-        return false;
+void SeatStateMap::releaseHeld(int ordinal) {
+    if (!hasState()) {
+        return;
     }
     
-    vector<Seat>& seats = showtimeSeats[showtimeId];
+    uint64_t bit = 1ULL << (ordinal & 63);
+    if (held_bits[ordinal >> 6] & bit) {
+        held_bits[ordinal >> 6] &= ~bit;
+        available_bits[ordinal >> 6] |= bit;
+        hold_expires_at[ordinal] = 0;
+        order_ids[ordinal] = 0;
+    }
+}
+
+int SeatStateMap::releaseSold(const vector<uint64_t>& mask, int orderId) {
+    if (!hasState()) {
+        return 0;
+    }
     
-    for (const string& seatId : seatIds) {
-        for (Seat& seat : seats) {
-            if (seat.getSeatId() == seatId && seat.getStatus() == "held") {
-                seat.setStatus("available");
-                seat.setHoldExpiresAt(0);
-                seat.setOrderId(0);
-                break;
+    int released = 0;
+    for (size_t w = 0; w < mask.size(); w++) {
+        for (uint64_t bits = mask[w] & sold_bits[w]; bits; bits &= bits - 1) {
+            int ordinal = (int)w * 64 + lowestBitIndex(bits);
+            if (order_ids[ordinal] == orderId) {
+                uint64_t bit = 1ULL << (ordinal & 63);
+                sold_bits[w] &= ~bit;
+                available_bits[w] |= bit;
+                order_ids[ordinal] = 0;
+                released++;
             }
         }
     }
-    
-    cout << "Held seats released." << endl;
-    return true;
+    return released;
 }
 
-void BookingService::releaseExpiredHolds() {
-    for (auto& showtimePair : showtimeSeats) {
-        vector<Seat>& seats = showtimePair.second;
-        for (Seat& seat : seats) {
-            if (seat.isHoldExpired()) {
-                seat.setStatus("available");
-                seat.setHoldExpiresAt(0);
-                seat.setOrderId(0);
+bool SeatStateMap::sell(const vector<uint64_t>& mask, int orderId) {
+    allocateState();
+    
+    // Every seat must be free or held for this order, otherwise nothing is sold
+    for (size_t w = 0; w < mask.size(); w++) {
+        for (uint64_t bits = mask[w] & ~available_bits[w]; bits; bits &= bits - 1) {
+            int ordinal = (int)w * 64 + lowestBitIndex(bits);
+            if (!isHeld(ordinal) || order_ids[ordinal] != orderId) {
+                return false;
             }
         }
     }
+    
+    for (size_t w = 0; w < mask.size(); w++) {
+        uint64_t bits = mask[w];
+        available_bits[w] &= ~bits;
+        held_bits[w] &= ~bits;
+        sold_bits[w] |= bits;
+        
+        for (; bits; bits &= bits - 1) {
+            int ordinal = (int)w * 64 + lowestBitIndex(bits);
+            hold_expires_at[ordinal] = 0;
+            order_ids[ordinal] = orderId;
+        }
+    }
+    return true;
 }
 
-bool BookingService::areSeatsAvailable(int showtimeId, const vector<string>& seatIds) const {
-    return validateSeatSelection(showtimeId, seatIds);
+uint64_t SeatStateMap::getRowAvailableMask(int rowIndex) const {
+    int start = layout->getRowStart(rowIndex);
+    int length = layout->getRowEnd(rowIndex) - start;
+    uint64_t rowBits = length == 64 ? ~0ULL : (1ULL << length) - 1;
+    if (!hasState()) {
+        return rowBits;
+    }
+    
+    int word = start >> 6;
+    int offset = start & 63;
+    
+    uint64_t bits = available_bits[word] >> offset;
+    if (offset != 0 && word + 1 < (int)available_bits.size()) {
+        bits |= available_bits[word + 1] << (64 - offset);
+    }
+    return bits & rowBits;
 }
 
-bool BookingService::createOrder(const Order& order) {
-    if (!order.isValid()) {
-        cout << "Error: Invalid order data!" << endl;
-        return false;
+// Center-weighted search: a contiguous block in one row closest to the middle of the room,
+// otherwise the request is split into the largest blocks that still fit.
+vector<int> SeatStateMap::findBestSeats(int count, const string& seatType) const {
+    vector<int> chosen;
+    int rowCount = layout->getRowCount();
+    if (count <= 0 || count > countAvailable()) {
+        return chosen;
     }
     
-    if (!validateSeatSelection(order.getShowtimeId(), order.getSeatIds())) {
-        return false;
+    vector<uint64_t> freeMasks(rowCount);
+    for (int row = 0; row < rowCount; row++) {
+        uint64_t typeMask = seatType.empty() ? ~0ULL : layout->getRowTypeMask(row, seatType);
+        freeMasks[row] = getRowAvailableMask(row) & typeMask;
     }
     
-    Order newOrder = order;
-    newOrder.setId(nextOrderId++);
-    orders.push_back(newOrder);
+    int remaining = count;
+    while (remaining > 0) {
+        int bestRow = -1;
+        int bestStart = 0;
+        int bestSize = 0;
+        int bestScore = 0;
+        
+        for (int size = remaining; size > 0 && bestRow < 0; size--) {
+            for (int row = 0; row < rowCount; row++) {
+                if ((int)bitset<64>(freeMasks[row]).count() < size) {
+                    continue;
+                }
+                uint64_t starts = blockStartMask(freeMasks[row], layout->getRowAdjacency(row), size);
+                if (!starts) {
+                    continue;
+                }
+                
+                // Start positions nearest to the one that centers the block, in half-seat units
+                int rowLength = layout->getRowEnd(row) - layout->getRowStart(row);
+                int target = (rowLength - size) / 2;
+                uint64_t atOrBelow = starts & ((2ULL << target) - 1);
+                uint64_t atOrAbove = starts & ~((1ULL << target) - 1);
+                int start = -1;
+                if (atOrAbove) {
+                    start = lowestBitIndex(atOrAbove);
+                }
+                if (atOrBelow) {
+                    int below = highestBitIndex(atOrBelow);
+                    if (start < 0 || abs(2 * below - (rowLength - size)) < abs(2 * start - (rowLength - size))) {
+                        start = below;
+                    }
+                }
+                
+                int score = abs(2 * start - (rowLength - size)) + abs(2 * row - (rowCount - 1));
+                if (bestRow < 0 || score < bestScore) {
+                    bestRow = row;
+                    bestStart = start;
+                    bestSize = size;
+                    bestScore = score;
+                }
+            }
+        }
+        
+        if (bestRow < 0) {
+            chosen.clear(); // Not enough seats of this type
+            return chosen;
+        }
+        
+        for (int i = 0; i < bestSize; i++) {
+            chosen.push_back(layout->getRowStart(bestRow) + bestStart + i);
+        }
+        freeMasks[bestRow] &= ~(((bestSize == 64) ? ~0ULL : ((1ULL << bestSize) - 1)) << bestStart);
+        remaining -= bestSize;
+    }
     
-    cout << "Order created successfully with ID: " << newOrder.getId() << endl;
-    return true;
+    return chosen;
 }
 
-bool BookingService::updateOrder(int orderId, const Order& updatedOrder) {
-    Order* order = findOrderById(orderId);
-    if (!order) {
-        cout << "Error: Order with ID " << orderId << " not found!" << endl;
-        return false;
+Seat SeatStateMap::getSeat(int ordinal) const {
+    Seat seat(layout->getSeatId(ordinal), layout->getType(ordinal));
+    seat.setPriceMultiplier(layout->getPriceMultiplier(ordinal));
+    if (isHeld(ordinal)) {
+        seat.setStatus(SeatStatus::HELD);
+        seat.setHoldExpiresAt(hold_expires_at[ordinal]);
+    } else if (isSold(ordinal)) {
+        seat.setStatus(SeatStatus::SOLD);
+    }
+    if (hasState()) {
+        seat.setOrderId(order_ids[ordinal]);
+    }
+    return seat;
+}
+
+vector<Seat> SeatStateMap::getSeats() const {
+    vector<Seat> seats;
+    seats.reserve(layout->getSeatCount());
+    for (int ordinal = 0; ordinal < layout->getSeatCount(); ordinal++) {
+        seats.push_back(getSeat(ordinal));
+    }
+    return seats;
+}
+
+// HoldTimerWheel class implementation
+HoldTimerWheel::HoldTimerWheel(time_t startTime) : current_time(startTime), pending_count(0) {}
+
+void HoldTimerWheel::place(const Entry& entry) {
+    // A hold is expired once the clock is past expires_at (see Seat::isHoldExpired)
+    time_t due = entry.expires_at + 1;
+    if (due <= current_time) {
+        overdue.push_back(entry);
+        return;
     }
     
-    if (!updatedOrder.isValid()) {
-        cout << "Error: Invalid order data!" << endl;
-        return false;
+    time_t delta = due - current_time;
+    for (int level = 0; level < LEVELS; level++) {
+        time_t span = (time_t)1 << (SLOT_BITS * (level + 1));
+        if (delta < span || level == LEVELS - 1) {
+            if (delta >= span) {
+                due = current_time + span - 1; // Park in the top level, re-placed on cascade
+            }
+            int slot = (int)((due >> (SLOT_BITS * level)) & (SLOTS - 1));
+            slots[level][slot].push_back(entry);
+            return;
+        }
+    }
+}
+
+void HoldTimerWheel::schedule(int showtimeId, int ordinal, time_t expiresAt) {
+    Entry entry = {showtimeId, ordinal, expiresAt};
+    pending_count++;
+    place(entry);
+}
+
+void HoldTimerWheel::advance(time_t now, vector<Entry>& expired) {
+    if (pending_count == 0) {
+        current_time = max(current_time, now); // Nothing to fire, just move the cursor
+        return;
     }
     
-    *order = updatedOrder;
-    order->setId(orderId); // Preserve original ID
+    expired.insert(expired.end(), overdue.begin(), overdue.end());
+    pending_count -= overdue.size();
+    overdue.clear();
     
-    cout << "Order updated successfully!" << endl;
-    return true;
+    while (current_time < now && pending_count > 0) {
+        current_time++;
+        
+        // Cascade upper levels whose slot boundary we just crossed, top level first
+        int topLevel = 0;
+        while (topLevel + 1 < LEVELS &&
+               (current_time & (((time_t)1 << (SLOT_BITS * (topLevel + 1))) - 1)) == 0) {
+            topLevel++;
+        }
+        for (int level = topLevel; level > 0; level--) {
+            int slot = (int)((current_time >> (SLOT_BITS * level)) & (SLOTS - 1));
+            vector<Entry> moved;
+            moved.swap(slots[level][slot]);
+            for (const Entry& entry : moved) {
+                place(entry);
+            }
+        }
+        
+        vector<Entry>& due = slots[0][current_time & (SLOTS - 1)];
+        for (const Entry& entry : due) {
+            expired.push_back(entry);
+        }
+        pending_count -= due.size();
+        due.clear();
+        
+        expired.insert(expired.end(), overdue.begin(), overdue.end());
+        pending_count -= overdue.size();
+        overdue.clear();
+    }
+    
+    current_time = max(current_time, now);
 }
 
-Order* BookingService::findOrderById(int orderId) {
-    for (auto& order : orders) {
-        if (order.getId() == orderId) {
-            return &order;
-        }
+// Order class implementation
+Order::Order() : id(0), staff_id(0), showtime_id(0), subtotal(0.0), tax(0.0), 
+                 discount(0.0), total_amount(0.0), payment_status(OrderPaymentStatus::PENDING),
+                 created_at(TimeService::now()), updated_at(TimeService::now()) {}
+
+Order::Order(int staffId, int showtimeId, const vector<string>& seatIds)
+    : id(0), staff_id(staffId), showtime_id(showtimeId), seat_ids(seatIds),
+      subtotal(0.0), tax(0.0), discount(0.0), total_amount(0.0), 
+      payment_status(OrderPaymentStatus::PENDING), created_at(TimeService::now()), updated_at(TimeService::now()) {}
+
+bool Order::setPaymentStatus(OrderPaymentStatus newStatus) {
+    if (!canTransition(payment_status, newStatus)) {
+        return false;
+    }
+    payment_status = newStatus;
+    updated_at = TimeService::now();
+    return true;
+}
+
+void Order::calculateTotal() {
+    total_amount = subtotal + tax - discount;
+    updated_at = TimeService::now();
+}
+
+void Order::displayInfo() const {
+    cout << "Order ID: " << id << " | Staff: " << staff_id 
+         << " | Showtime: " << showtime_id << " | Seats: ";
+    for (const auto& seat : seat_ids) {
+        cout << seat << " ";
+    }
+    cout << endl;
+    cout << "Subtotal: $" << subtotal << " | Tax: $" << tax 
+         << " | Discount: $" << discount << " | Total: $" << total_amount << endl;
+    cout << "Status: " << toString(payment_status) << " | Customer: " << customer_name 
+         << " | Phone: " << customer_phone << endl;
+}
+
+bool Order::isValid() const {
+    return staff_id > 0 && showtime_id > 0 && !seat_ids.empty() && total_amount >= 0;
+}
+
+// Ticket class implementation
+Ticket::Ticket() : ticket_id(""), order_id(0), showtime_id(0), seat_id(""),
+                   show_time(0), price(0.0), status(TicketStatus::VALID), issued_at(TimeService::now()) {}
+
+Ticket::Ticket(int orderId, int showtimeId, const string& seatId)
+    : order_id(orderId), showtime_id(showtimeId), seat_id(seatId),
+      show_time(0), price(0.0), status(TicketStatus::VALID), issued_at(TimeService::now()) {
+    // ticket_id is assigned by BookingService when the ticket is issued
+}
+
+bool Ticket::setStatus(TicketStatus newStatus) {
+    if (!canTransition(status, newStatus)) {
+        return false;
+    }
+    status = newStatus;
+    return true;
+}
+
+void Ticket::displayTicket() const {
+    cout << "\n========== CINEMA TICKET ==========" << endl;
+    cout << "Ticket ID: " << ticket_id << endl;
+    cout << "Movie: " << movie_title << endl;
+    cout << "Auditorium: " << auditorium_name << endl;
+    cout << "Seat: " << seat_id << endl;
+    
+    cout << "Show Time: " << TimeService::formatDateTime(show_time) << endl;
+    
+    cout << "Price: $" << fixed << setprecision(2) << price << endl;
+    cout << "Status: " << toString(status) << endl;
+    
+    cout << "Issued: " << TimeService::formatDateTime(issued_at) << endl;
+    cout << "===================================" << endl;
+}
+
+string Ticket::generateTicketId(int serial) {
+    stringstream ss;
+    ss << "TKT" << setfill('0') << setw(6) << serial;
+    return ss.str();
+}
+
+bool Ticket::isValid() const {
+    return !ticket_id.empty() && order_id > 0 && showtime_id > 0 && 
+           !seat_id.empty() && status == TicketStatus::VALID;
+}
+
+// BookingService class implementation
+static atomic<unsigned long long> bookingServiceCount(0);
+
+BookingService::BookingService(const Clock& clock)
+    : nextOrderId(1), nextTicketBlock(0), instanceId(++bookingServiceCount), timeSource(clock) {
+    // Initialize sample seat maps for showtimes
+    initializeSeatsForShowtime(1, getDefaultLayout(100)); // Showtime 1 with 100 seats
+    initializeSeatsForShowtime(2, getDefaultLayout(150)); // Showtime 2 with 150 seats
+}
+
+SeatShard* BookingService::findShard(int showtimeId) const {
+    lock_guard<mutex> guard(seatMapsMutex);
+    auto it = showtimeSeats.find(showtimeId);
+    return it != showtimeSeats.end() ? it->second.get() : nullptr;
+}
+
+vector<SeatShard*> BookingService::getAllShards() const {
+    lock_guard<mutex> guard(seatMapsMutex);
+    vector<SeatShard*> shards;
+    for (const auto& showtimePair : showtimeSeats) {
+        shards.push_back(showtimePair.second.get());
+    }
+    return shards;
+}
+
+bool BookingService::validateSeatSelection(int showtimeId, const vector<string>& seatIds) const {
+    SeatShard* shard = findShard(showtimeId);
+    string error = seatIds.empty() ? "No seats selected!" : "Showtime not found!";
+    bool valid = false;
+    
+    if (shard && !seatIds.empty()) {
+        lock_guard<mutex> guard(shard->lock);
+        vector<uint64_t> mask;
+        valid = buildSeatMask(shard->seats, seatIds, mask, error);
+    }
+    
+    if (!valid) {
+        cout << "Error: " << error << endl;
+    }
+    return valid;
+}
+
+bool BookingService::buildSeatMask(const SeatStateMap& seats, const vector<string>& seatIds, 
+                                   vector<uint64_t>& mask, string& error) const {
+    // Check if all seats are valid and available
+    string unknownSeatId;
+    if (!seats.buildMask(seatIds, mask, unknownSeatId)) {
+        error = "Seat " + unknownSeatId + " does not exist!";
+        return false;
+    }
+    
+    int blocked = seats.firstUnavailable(mask);
+    if (blocked >= 0) {
+        error = "Seat " + seats.getLayout().getSeatId(blocked) + " is not available!";
+        return false;
+    }
+    
+    return true;
+}
+
+// Checks and holds the requested seats under the showtime's lock: either every seat is held or none.
+// logHold runs under that lock with the hold's expiry, so its log record precedes any later change to the seats.
+bool BookingService::acquireSeats(int showtimeId, const vector<string>& seatIds, int& holdTimeSeconds, 
+                                  int orderId, time_t& holdExpiry, string& error, 
+                                  const function<void(time_t)>& logHold) {
+    if (seatIds.empty()) {
+        error = "No seats selected!";
+        return false;
+    }
+    
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        error = "Showtime not found!";
+        return false;
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    time_t now = timeSource.now();
+    expireHolds(*shard, now);
+    
+    vector<uint64_t> mask;
+    if (!buildSeatMask(shard->seats, seatIds, mask, error)) {
+        return false;
+    }
+    
+    if (holdTimeSeconds <= 0) {
+        holdTimeSeconds = shard->seats.getHoldTimeout();
+    }
+    holdExpiry = now + holdTimeSeconds;
+    holdSeatsUntil(*shard, showtimeId, mask, holdExpiry, orderId);
+    if (logHold) {
+        logHold(holdExpiry);
+    }
+    return true;
+}
+
+// Takes back a hold whose log write failed; seats the hold no longer owns are left alone
+void BookingService::undoHold(int showtimeId, const vector<string>& seatIds, int orderId, time_t holdExpiry) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        return;
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    vector<uint64_t> mask;
+    string unknownSeatId;
+    shard->seats.buildMask(seatIds, mask, unknownSeatId);
+    for (size_t w = 0; w < mask.size(); w++) {
+        for (uint64_t bits = mask[w]; bits; bits &= bits - 1) {
+            int ordinal = (int)w * 64 + lowestBitIndex(bits);
+            if (shard->seats.isHeld(ordinal) && shard->seats.getOrderId(ordinal) == orderId && 
+                shard->seats.getHoldExpiresAt(ordinal) == holdExpiry) {
+                shard->seats.releaseHeld(ordinal);
+            }
+        }
+    }
+}
+
+// Caller holds the shard's lock; the masked seats held or sold for orderId (0 = no order)
+void BookingService::collectClaims(const SeatStateMap& seats, const vector<uint64_t>& mask, int orderId, 
+                                   vector<SeatClaim>& claims) {
+    for (size_t w = 0; w < mask.size(); w++) {
+        for (uint64_t bits = mask[w]; bits; bits &= bits - 1) {
+            int ordinal = (int)w * 64 + lowestBitIndex(bits);
+            if ((seats.isHeld(ordinal) || seats.isSold(ordinal)) && seats.getOrderId(ordinal) == orderId) {
+                SeatClaim claim = {ordinal, seats.isSold(ordinal), seats.getHoldExpiresAt(ordinal)};
+                claims.push_back(claim);
+            }
+        }
+    }
+}
+
+// Caller holds shard.lock; puts back claims whose seats are still free and whose hold has not run out.
+// Returns the number of seats sold again.
+int BookingService::restoreClaims(SeatShard& shard, int showtimeId, const vector<SeatClaim>& claims, int orderId) {
+    time_t now = timeSource.now();
+    vector<uint64_t> mask(shard.seats.getWordCount());
+    int sold = 0;
+    for (const SeatClaim& claim : claims) {
+        if (!shard.seats.isAvailable(claim.ordinal) || (!claim.sold && claim.hold_expires_at < now)) {
+            continue;
+        }
+        fill(mask.begin(), mask.end(), 0);
+        mask[claim.ordinal >> 6] = 1ULL << (claim.ordinal & 63);
+        if (claim.sold) {
+            shard.seats.sell(mask, orderId);
+            sold++;
+        } else {
+            holdSeatsUntil(shard, showtimeId, mask, claim.hold_expires_at, orderId);
+        }
+    }
+    return sold;
+}
+
+// Caller holds shard.lock
+void BookingService::holdSeatsUntil(SeatShard& shard, int showtimeId, const vector<uint64_t>& mask, 
+                                    time_t holdExpiry, int orderId) {
+    shard.seats.hold(mask, holdExpiry, orderId);
+    
+    if (!shard.timers) {
+        shard.timers.reset(new HoldTimerWheel(timeSource.now()));
+    }
+    for (size_t w = 0; w < mask.size(); w++) {
+        for (uint64_t bits = mask[w]; bits; bits &= bits - 1) {
+            shard.timers->schedule(showtimeId, (int)w * 64 + lowestBitIndex(bits), holdExpiry);
+        }
+    }
+    
+    lock_guard<mutex> guard(holdDeadlinesMutex);
+    drainHoldDeadlines(timeSource.now());
+    holdDeadlines.insert(make_pair(holdExpiry, showtimeId));
+}
+
+// Caller holds holdDeadlinesMutex
+void BookingService::drainHoldDeadlines(time_t now) {
+    while (!holdDeadlines.empty() && holdDeadlines.begin()->first < now) {
+        dueShowtimes.insert(holdDeadlines.begin()->second);
+        holdDeadlines.erase(holdDeadlines.begin());
+    }
+}
+
+// Old seats an exchange gives up; seats kept in the same showtime stay with the order
+static vector<string> exchangedSeats(const Order& order, int newShowtimeId, const vector<string>& newSeatIds) {
+    if (order.getShowtimeId() != newShowtimeId) {
+        return order.getSeatIds();
+    }
+    vector<string> seatIds;
+    for (const string& seatId : order.getSeatIds()) {
+        if (find(newSeatIds.begin(), newSeatIds.end(), seatId) == newSeatIds.end()) {
+            seatIds.push_back(seatId);
+        }
+    }
+    return seatIds;
+}
+
+// New seats an exchange has to acquire; seats the order already has in that showtime are kept as they are
+static vector<string> addedSeats(const Order& order, int newShowtimeId, const vector<string>& newSeatIds) {
+    if (order.getShowtimeId() != newShowtimeId) {
+        return newSeatIds;
+    }
+    vector<string> orderSeatIds = order.getSeatIds();
+    vector<string> seatIds;
+    for (const string& seatId : newSeatIds) {
+        if (find(orderSeatIds.begin(), orderSeatIds.end(), seatId) == orderSeatIds.end()) {
+            seatIds.push_back(seatId);
+        }
+    }
+    return seatIds;
+}
+
+// Releases an order's seats whether held or sold; returns the number of sold seats freed.
+// released (optional) receives the seats as they were; logRelease runs under the showtime's lock,
+// so its log record precedes any later claim on the freed seats.
+int BookingService::releaseOrderSeats(int showtimeId, const vector<string>& seatIds, int orderId, 
+                                      vector<SeatClaim>* released, const function<void()>& logRelease) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        if (logRelease) {
+            logRelease();
+        }
+        return 0;
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    vector<uint64_t> mask;
+    string unknownSeatId;
+    shard->seats.buildMask(seatIds, mask, unknownSeatId);
+    if (released) {
+        collectClaims(shard->seats, mask, orderId, *released);
+    }
+    shard->seats.releaseHeld(mask, orderId);
+    int soldFreed = shard->seats.releaseSold(mask, orderId);
+    if (logRelease) {
+        logRelease();
+    }
+    return soldFreed;
+}
+
+// Caller holds ordersMutex; puts back what a cancel or refund released when its log write failed
+void BookingService::undoOrderRelease(Order& order, const vector<SeatClaim>& released, 
+                                      OrderPaymentStatus previousStatus) {
+    SeatShard* shard = findShard(order.getShowtimeId());
+    if (shard) {
+        int soldDelta;
+        {
+            lock_guard<mutex> guard(shard->lock);
+            soldDelta = restoreClaims(*shard, order.getShowtimeId(), released, order.getId());
+        }
+        publishSoldSeats(order.getShowtimeId(), soldDelta);
+    }
+    order.loadPaymentStatus(previousStatus);
+}
+
+// Returns the number of seats newly sold, or -1 if a seat is taken by someone else
+int BookingService::sellOrderSeats(int showtimeId, const vector<string>& seatIds, int orderId) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        return 0;
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    vector<uint64_t> mask;
+    string unknownSeatId;
+    shard->seats.buildMask(seatIds, mask, unknownSeatId);
+    int soldBefore = shard->seats.countSold();
+    if (!shard->seats.sell(mask, orderId)) {
+        return -1;
+    }
+    return shard->seats.countSold() - soldBefore;
+}
+
+void BookingService::publishSoldSeats(int showtimeId, int soldDelta) {
+    if (soldDelta == 0) {
+        return;
+    }
+    lock_guard<mutex> guard(soldSeatsListenerMutex);
+    if (soldSeatsListener) {
+        soldSeatsListener(showtimeId, soldDelta);
+    }
+}
+
+void BookingService::releaseSeats(int showtimeId, const vector<string>& seatIds) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        return;
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    vector<uint64_t> mask;
+    string unknownSeatId;
+    shard->seats.buildMask(seatIds, mask, unknownSeatId); // Unknown seats are skipped
+    shard->seats.releaseHeld(mask, 0); // Seats an order holds stay with the order
+}
+
+// Caller holds shard.lock
+void BookingService::expireHolds(SeatShard& shard, time_t now) {
+    if (!shard.timers) {
+        return;
+    }
+    
+    vector<HoldTimerWheel::Entry> expired;
+    shard.timers->advance(now, expired);
+    
+    for (const auto& entry : expired) {
+        // Skip timers of holds that were released, sold or re-held in the meantime
+        if (shard.seats.isHeld(entry.ordinal) && shard.seats.getHoldExpiresAt(entry.ordinal) == entry.expires_at) {
+            shard.seats.releaseHeld(entry.ordinal);
+        }
+    }
+}
+
+// Seats the layout does not know (or a showtime without seats) are charged the base price
+double BookingService::calculateSeatPrice(const SeatLayout* layout, const string& seatId, double basePrice) const {
+    int ordinal = layout ? layout->findOrdinal(seatId) : -1;
+    if (ordinal < 0) {
+        return basePrice;
+    }
+    return basePrice * layout->getPriceMultiplier(ordinal);
+}
+
+// Generated layouts are shared by every showtime with the same seat count
+shared_ptr<const SeatLayout> BookingService::getDefaultLayout(int totalSeats) {
+    {
+        lock_guard<mutex> guard(seatMapsMutex);
+        auto it = defaultLayouts.find(totalSeats);
+        if (it != defaultLayouts.end()) {
+            return it->second;
+        }
+    }
+    
+    shared_ptr<SeatLayout> layout = make_shared<SeatLayout>();
+    
+    // Generate seat layout (simplified)
+    int seatsPerRow = 10;
+    int rows = (totalSeats + seatsPerRow - 1) / seatsPerRow;
+    
+    for (int row = 0; row < rows; row++) {
+        char rowLetter = 'A' + row;
+        layout->addRow(string(1, rowLetter));
+        for (int seatNum = 1; seatNum <= seatsPerRow && layout->getSeatCount() < totalSeats; seatNum++) {
+            stringstream ss;
+            ss << rowLetter << setfill('0') << setw(2) << seatNum;
+            string seatId = ss.str();
+            
+            string seatType = "Standard";
+            if (row >= rows - 2) { // Last 2 rows are VIP
+                seatType = "VIP";
+            } else if (seatNum == 5 || seatNum == 6) { // Middle seats are couple seats
+                seatType = "Couple";
+            }
+            
+            layout->addSeat(seatId, seatType);
+        }
+    }
+    
+    lock_guard<mutex> guard(seatMapsMutex);
+    return defaultLayouts.insert(make_pair(totalSeats, layout)).first->second;
+}
+
+void BookingService::initializeSeatsForShowtime(int showtimeId, const shared_ptr<const SeatLayout>& layout, 
+                                                int holdTimeoutSeconds) {
+    SeatShard* shard;
+    {
+        lock_guard<mutex> guard(seatMapsMutex);
+        unique_ptr<SeatShard>& slot = showtimeSeats[showtimeId];
+        if (!slot) {
+            slot.reset(new SeatShard());
+        }
+        shard = slot.get();
+    }
+    
+    // Re-initialize in place so terminals holding the shard keep a valid pointer
+    lock_guard<mutex> guard(shard->lock);
+    shard->seats = SeatStateMap(layout, holdTimeoutSeconds);
+    shard->timers.reset();
+}
+
+// Heap sort implementation for seats
+vector<Seat> BookingService::heapSortSeats(vector<Seat> seatList, bool byPrice) const {
+    make_heap(seatList.begin(), seatList.end(), [byPrice](const Seat& a, const Seat& b) {
+        if (byPrice) {
+            return a.getPriceMultiplier() < b.getPriceMultiplier();
+        }
+        return a.getSeatId() > b.getSeatId(); // Sort by seat ID
+    });
+    
+    sort_heap(seatList.begin(), seatList.end(), [byPrice](const Seat& a, const Seat& b) {
+        if (byPrice) {
+            return a.getPriceMultiplier() < b.getPriceMultiplier();
+        }
+        return a.getSeatId() > b.getSeatId();
+    });
+    
+    return seatList;
+}
+
+bool BookingService::registerAuditorium(const Auditorium& auditorium) {
+    if (auditorium.getId() <= 0 || auditorium.getCapacity() <= 0) {
+        cout << "Error: Invalid auditorium data!" << endl;
+        return false;
+    }
+    
+    shared_ptr<const SeatLayout> layout;
+    if (!auditorium.getSeatMap().empty()) {
+        string error;
+        layout = SeatMapCompiler::compile(auditorium.getSeatMap(), error);
+        if (!layout) {
+            cout << "Error: Invalid seat map for " << auditorium.getName() << ": " << error << endl;
+        } else if (layout->getSeatCount() != auditorium.getCapacity()) {
+            cout << "Warning: Seat map of " << auditorium.getName() << " has " << layout->getSeatCount()
+                 << " seats, capacity is " << auditorium.getCapacity() << endl;
+        }
+    }
+    if (!layout) {
+        layout = getDefaultLayout(auditorium.getCapacity());
+    }
+    
+    // Showtimes already on the old layout keep it through their shared pointer
+    lock_guard<mutex> guard(seatMapsMutex);
+    auditoriumLayouts[auditorium.getId()] = layout;
+    return true;
+}
+
+bool BookingService::registerShowtime(const Showtime& showtime) {
+    if (showtime.getId() <= 0 || showtime.getSeatsTotal() <= 0) {
+        cout << "Error: Invalid showtime data!" << endl;
+        return false;
+    }
+    
+    shared_ptr<const SeatLayout> layout;
+    {
+        lock_guard<mutex> guard(seatMapsMutex);
+        auto it = auditoriumLayouts.find(showtime.getAuditoriumId());
+        if (it != auditoriumLayouts.end()) {
+            layout = it->second;
+        }
+    }
+    if (!layout) {
+        layout = getDefaultLayout(showtime.getSeatsTotal());
+    }
+    
+    // Keep existing seat states once seats were held or sold, only pick up the hold timeout
+    SeatShard* shard = findShard(showtime.getId());
+    if (shard) {
+        lock_guard<mutex> guard(shard->lock);
+        if (shard->seats.hasState() || shard->seats.getSharedLayout() == layout) {
+            shard->seats.setHoldTimeout(showtime.getHoldTimeout());
+            return true;
+        }
+    }
+    
+    initializeSeatsForShowtime(showtime.getId(), layout, showtime.getHoldTimeout());
+    return true;
+}
+
+bool BookingService::setHoldTimeout(int showtimeId, int holdTimeoutSeconds) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard || holdTimeoutSeconds <= 0) {
+        return false;
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    shard->seats.setHoldTimeout(holdTimeoutSeconds);
+    return true;
+}
+
+vector<Seat> BookingService::getSeatsForShowtime(int showtimeId) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        return vector<Seat>();
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    return shard->seats.getSeats();
+}
+
+bool BookingService::holdSeats(int showtimeId, const vector<string>& seatIds, int holdTimeMinutes) {
+    int holdTimeSeconds = holdTimeMinutes * 60;
+    string error;
+    if (!holdAndLogSeats(showtimeId, seatIds, holdTimeSeconds, error)) {
+        cout << "Error: " << error << endl;
+        return false;
+    }
+    
+    cout << "Seats held for " << holdTimeSeconds << " seconds." << endl;
+    return true;
+}
+
+bool BookingService::tryHoldSeats(int showtimeId, const vector<string>& seatIds, int holdTimeSeconds) {
+    string error;
+    return holdAndLogSeats(showtimeId, seatIds, holdTimeSeconds, error);
+}
+
+bool BookingService::holdAndLogSeats(int showtimeId, const vector<string>& seatIds, int& holdTimeSeconds, 
+                                     string& error) {
+    time_t holdExpiry = 0;
+    uint64_t lsn = 0;
+    auto logHold = [this, showtimeId, &seatIds, &lsn](time_t expiry) {
+        BookingLogRecord record(BookingLog::HOLD_SEATS);
+        record.putInt(showtimeId);
+        record.putInt(expiry);
+        record.putStrings(seatIds);
+        lsn = logRecord(record);
+    };
+    if (!acquireSeats(showtimeId, seatIds, holdTimeSeconds, 0, holdExpiry, error, logHold)) {
+        return false;
+    }
+    
+    if (!syncLog(lsn)) {
+        undoHold(showtimeId, seatIds, 0, holdExpiry);
+        error = "Booking log write failed!";
+        return false;
+    }
+    return true;
+}
+
+bool BookingService::releaseHeldSeats(int showtimeId, const vector<string>& seatIds) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        return false;
+    }
+    
+    vector<SeatClaim> released; // Put back if the log write fails
+    uint64_t lsn;
+    {
+        lock_guard<mutex> guard(shard->lock);
+        vector<uint64_t> mask;
+        string unknownSeatId;
+        shard->seats.buildMask(seatIds, mask, unknownSeatId); // Unknown seats are skipped
+        collectClaims(shard->seats, mask, 0, released);
+        shard->seats.releaseHeld(mask, 0); // Seats an order holds stay with the order
+        
+        BookingLogRecord record(BookingLog::RELEASE_SEATS);
+        record.putInt(showtimeId);
+        record.putStrings(seatIds);
+        lsn = logRecord(record);
+    }
+    if (!syncLog(lsn)) {
+        lock_guard<mutex> guard(shard->lock);
+        restoreClaims(*shard, showtimeId, released, 0);
+        cout << "Error: Booking log write failed!" << endl;
+        return false;
+    }
+    
+    cout << "Held seats released." << endl;
+    return true;
+}
+
+// Only showtimes with a hold deadline behind them are locked; holds released early leave a harmless visit
+void BookingService::releaseExpiredHolds() {
+    time_t now = timeSource.now();
+    set<int> dueShowtimeIds;
+    {
+        lock_guard<mutex> guard(holdDeadlinesMutex);
+        drainHoldDeadlines(now);
+        dueShowtimeIds.swap(dueShowtimes);
+    }
+    
+    for (int showtimeId : dueShowtimeIds) {
+        SeatShard* shard = findShard(showtimeId);
+        if (shard) {
+            lock_guard<mutex> guard(shard->lock);
+            expireHolds(*shard, now);
+        }
+    }
+}
+
+bool BookingService::areSeatsAvailable(int showtimeId, const vector<string>& seatIds) const {
+    return validateSeatSelection(showtimeId, seatIds);
+}
+
+int BookingService::getAvailableSeatCount(int showtimeId) const {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        return 0;
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    return shard->seats.countAvailable();
+}
+
+vector<string> BookingService::findBestSeats(int showtimeId, int count, const string& seatType) const {
+    vector<string> seatIds;
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        return seatIds;
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    for (int ordinal : shard->seats.findBestSeats(count, seatType)) {
+        seatIds.push_back(shard->seats.getLayout().getSeatId(ordinal));
+    }
+    return seatIds;
+}
+
+vector<SeatCommandResult> BookingService::executeSeatCommands(const vector<SeatCommand>& commands) {
+    vector<SeatCommandResult> results(commands.size());
+    vector<Order*> confirmOrders(commands.size(), nullptr);
+    vector<vector<SeatClaim>> claims(commands.size()); // Seats a release or confirm took over, for undo
+    uint64_t lsn = 0;
+    
+    bool hasConfirm = false;
+    for (const auto& command : commands) {
+        hasConfirm = hasConfirm || command.action == "confirm";
+    }
+    
+    // Confirms need the order book; it is locked before any showtime (lock order)
+    unique_lock<recursive_mutex> ordersGuard(ordersMutex, defer_lock);
+    if (hasConfirm) {
+        ordersGuard.lock();
+    }
+    
+    // Group command indexes by showtime, keeping their order within a group
+    map<int, vector<size_t>> groups;
+    for (size_t i = 0; i < commands.size(); i++) {
+        const SeatCommand& command = commands[i];
+        int showtimeId = command.showtime_id;
+        if (command.action == "confirm") {
+            confirmOrders[i] = findOrderById(command.order_id);
+            if (!confirmOrders[i]) {
+                results[i].error = "Order not found!";
+                continue;
+            }
+            if (!canTransition(confirmOrders[i]->getPaymentStatus(), OrderPaymentStatus::PAID)) {
+                results[i].error = string("Cannot confirm a ") + toString(confirmOrders[i]->getPaymentStatus()) + " order!";
+                confirmOrders[i] = nullptr;
+                continue;
+            }
+            showtimeId = confirmOrders[i]->getShowtimeId();
+        } else if (command.action != "hold" && command.action != "release") {
+            results[i].error = "Unknown action " + command.action + "!";
+            continue;
+        }
+        groups[showtimeId].push_back(i);
+    }
+    
+    for (const auto& group : groups) {
+        int soldDelta = 0;
+        executeShowtimeCommands(group.first, commands, group.second, results, confirmOrders, claims, lsn, soldDelta);
+        publishSoldSeats(group.first, soldDelta);
+    }
+    
+    // Sold orders become paid and get their tickets once the showtime locks are released
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (confirmOrders[i] && results[i].success) {
+            confirmOrders[i]->setPaymentStatus(OrderPaymentStatus::PAID);
+            BookingLogRecord record(BookingLog::CONFIRM_BOOKING);
+            record.putInt(confirmOrders[i]->getId());
+            logRecord(record);
+            lsn = max(lsn, issueTicketsFor(*confirmOrders[i]));
+        }
+    }
+    if (ordersGuard.owns_lock()) {
+        ordersGuard.unlock();
+    }
+    
+    // One durable write for the whole batch; if it fails, no command of the batch stays applied
+    if (!syncLog(lsn)) {
+        undoSeatCommands(commands, results, confirmOrders, claims);
+    }
+    return results;
+}
+
+// Takes back a batch whose log write failed, last command first, and reports each applied command as failed
+void BookingService::undoSeatCommands(const vector<SeatCommand>& commands, vector<SeatCommandResult>& results, 
+                                      const vector<Order*>& confirmOrders, 
+                                      const vector<vector<SeatClaim>>& claims) {
+    lock_guard<recursive_mutex> ordersGuard(ordersMutex); // Lock order: before any showtime
+    for (size_t i = commands.size(); i-- > 0;) {
+        if (!results[i].success) {
+            continue;
+        }
+        const SeatCommand& command = commands[i];
+        results[i].success = false;
+        results[i].error = "Booking log write failed!";
+        
+        if (command.action == "hold") {
+            undoHold(command.showtime_id, command.seat_ids, 0, results[i].hold_expires_at);
+            results[i].hold_expires_at = 0;
+            continue;
+        }
+        
+        Order* order = confirmOrders[i];
+        int showtimeId = order ? order->getShowtimeId() : command.showtime_id;
+        SeatShard* shard = findShard(showtimeId);
+        int soldDelta = 0;
+        {
+            lock_guard<mutex> guard(shard->lock);
+            if (order) {
+                vector<uint64_t> mask;
+                string unknownSeatId;
+                shard->seats.buildMask(order->getSeatIds(), mask, unknownSeatId);
+                soldDelta -= shard->seats.releaseSold(mask, order->getId());
+            }
+            soldDelta += restoreClaims(*shard, showtimeId, claims[i], order ? order->getId() : 0);
+        }
+        publishSoldSeats(showtimeId, soldDelta);
+        
+        if (order) {
+            order->loadPaymentStatus(OrderPaymentStatus::PENDING);
+            cancelTicketsOfOrder(order->getId());
+        }
+    }
+}
+
+// Applies one showtime's commands under a single lock, after one hold expiry pass
+void BookingService::executeShowtimeCommands(int showtimeId, const vector<SeatCommand>& commands, 
+                                             const vector<size_t>& group, vector<SeatCommandResult>& results,
+                                             vector<Order*>& confirmOrders, vector<vector<SeatClaim>>& claims, 
+                                             uint64_t& lsn, int& soldDelta) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
+        for (size_t i : group) {
+            results[i].error = "Showtime not found!";
+        }
+        return;
+    }
+    
+    lock_guard<mutex> guard(shard->lock);
+    time_t now = timeSource.now();
+    expireHolds(*shard, now);
+    
+    vector<uint64_t> mask;
+    for (size_t i : group) {
+        const SeatCommand& command = commands[i];
+        SeatCommandResult& result = results[i];
+        
+        if (command.action == "hold") {
+            if (command.seat_ids.empty()) {
+                result.error = "No seats selected!";
+                continue;
+            }
+            if (!buildSeatMask(shard->seats, command.seat_ids, mask, result.error)) {
+                continue;
+            }
+            int holdTimeSeconds = command.hold_seconds > 0 ? command.hold_seconds : shard->seats.getHoldTimeout();
+            result.hold_expires_at = now + holdTimeSeconds;
+            holdSeatsUntil(*shard, showtimeId, mask, result.hold_expires_at, 0);
+            
+            BookingLogRecord record(BookingLog::HOLD_SEATS);
+            record.putInt(showtimeId);
+            record.putInt(result.hold_expires_at);
+            record.putStrings(command.seat_ids);
+            lsn = max(lsn, logRecord(record));
+        } else if (command.action == "release") {
+            string unknownSeatId;
+            shard->seats.buildMask(command.seat_ids, mask, unknownSeatId); // Unknown seats are skipped
+            collectClaims(shard->seats, mask, 0, claims[i]);
+            shard->seats.releaseHeld(mask, 0);
+            
+            BookingLogRecord record(BookingLog::RELEASE_SEATS);
+            record.putInt(showtimeId);
+            record.putStrings(command.seat_ids);
+            lsn = max(lsn, logRecord(record));
+        } else {
+            string unknownSeatId;
+            shard->seats.buildMask(confirmOrders[i]->getSeatIds(), mask, unknownSeatId);
+            collectClaims(shard->seats, mask, command.order_id, claims[i]);
+            int soldBefore = shard->seats.countSold();
+            if (!shard->seats.sell(mask, command.order_id)) {
+                result.error = "Some seats of this order are no longer available!";
+                continue;
+            }
+            soldDelta += shard->seats.countSold() - soldBefore;
+        }
+        result.success = true;
+    }
+}
+
+bool BookingService::createOrder(const Order& order) {
+    if (!order.isValid()) {
+        cout << "Error: Invalid order data!" << endl;
+        return false;
+    }
+    
+    // Hold the order's seats atomically so two terminals cannot both create an order for them;
+    // the order is added and logged under the showtime's lock, so no later change to its seats is logged first
+    int orderId = nextOrderId++;
+    int holdTimeSeconds = 0;
+    time_t holdExpiry = 0;
+    string error;
+    uint64_t lsn = 0;
+    auto addOrder = [this, &order, orderId, &lsn](time_t expiry) {
+        orders.push_back(order);
+        orders.back().setId(orderId);
+        indexOrder(orders.size() - 1);
+        
+        BookingLogRecord record(BookingLog::CREATE_ORDER);
+        writeOrder(record, orders.back());
+        record.putInt(expiry);
+        lsn = logRecord(record);
+    };
+    {
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        if (!acquireSeats(order.getShowtimeId(), order.getSeatIds(), holdTimeSeconds, orderId, holdExpiry, 
+                          error, addOrder)) {
+            cout << "Error: " << error << endl;
+            return false;
+        }
+    }
+    if (!syncLog(lsn)) {
+        undoHold(order.getShowtimeId(), order.getSeatIds(), orderId, holdExpiry);
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        findOrderById(orderId)->setPaymentStatus(OrderPaymentStatus::CANCELED);
+        cout << "Error: Booking log write failed!" << endl;
+        return false;
+    }
+    
+    cout << "Order created successfully with ID: " << orderId << endl;
+    return true;
+}
+
+bool BookingService::updateOrder(int orderId, const Order& updatedOrder) {
+    uint64_t lsn;
+    {
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        Order* order = findOrderById(orderId);
+        if (!order) {
+            cout << "Error: Order with ID " << orderId << " not found!" << endl;
+            return false;
+        }
+        
+        if (!updatedOrder.isValid()) {
+            cout << "Error: Invalid order data!" << endl;
+            return false;
+        }
+        
+        if (updatedOrder.getPaymentStatus() != order->getPaymentStatus() && 
+            !canTransition(order->getPaymentStatus(), updatedOrder.getPaymentStatus())) {
+            cout << "Error: Cannot change order status from " << toString(order->getPaymentStatus()) 
+                 << " to " << toString(updatedOrder.getPaymentStatus()) << "!" << endl;
+            return false;
+        }
+        
+        size_t slot = orderIndex[orderId];
+        unindexOrder(slot);
+        *order = updatedOrder;
+        order->setId(orderId); // Preserve original ID
+        indexOrder(slot);
+        
+        BookingLogRecord record(BookingLog::UPDATE_ORDER);
+        writeOrder(record, *order);
+        lsn = logRecord(record);
+    }
+    if (!syncLog(lsn)) {
+        cout << "Error: Booking log write failed!" << endl;
+        return false;
+    }
+    
+    cout << "Order updated successfully!" << endl;
+    return true;
+}
+
+// Posting lists hold slots in ascending order, which is creation order
+static void addPosting(vector<size_t>& slots, size_t slot) {
+    if (slots.empty() || slots.back() < slot) {
+        slots.push_back(slot);
+    } else {
+        slots.insert(lower_bound(slots.begin(), slots.end(), slot), slot);
+    }
+}
+
+static void removePosting(vector<size_t>& slots, size_t slot) {
+    auto it = lower_bound(slots.begin(), slots.end(), slot);
+    if (it != slots.end() && *it == slot) {
+        slots.erase(it);
+    }
+}
+
+void BookingService::indexOrder(size_t slot) {
+    const Order& order = orders[slot];
+    orderIndex[order.getId()] = slot;
+    addPosting(ordersByStaff[order.getStaffId()], slot);
+    addPosting(ordersByShowtime[order.getShowtimeId()], slot);
+    if (!order.getCustomerPhone().empty()) {
+        addPosting(ordersByPhone[order.getCustomerPhone()], slot);
+    }
+}
+
+// Drops the secondary postings of a slot before its indexed fields change
+void BookingService::unindexOrder(size_t slot) {
+    const Order& order = orders[slot];
+    
+    auto staffIt = ordersByStaff.find(order.getStaffId());
+    if (staffIt != ordersByStaff.end()) {
+        removePosting(staffIt->second, slot);
+        if (staffIt->second.empty()) {
+            ordersByStaff.erase(staffIt);
+        }
+    }
+    auto showtimeIt = ordersByShowtime.find(order.getShowtimeId());
+    if (showtimeIt != ordersByShowtime.end()) {
+        removePosting(showtimeIt->second, slot);
+        if (showtimeIt->second.empty()) {
+            ordersByShowtime.erase(showtimeIt);
+        }
+    }
+    auto phoneIt = ordersByPhone.find(order.getCustomerPhone());
+    if (phoneIt != ordersByPhone.end()) {
+        removePosting(phoneIt->second, slot);
+        if (phoneIt->second.empty()) {
+            ordersByPhone.erase(phoneIt);
+        }
+    }
+}
+
+vector<const Order*> BookingService::collectOrders(const vector<size_t>* slots) const {
+    vector<const Order*> results;
+    if (slots) {
+        results.reserve(slots->size());
+        for (size_t slot : *slots) {
+            results.push_back(&orders[slot]);
+        }
+    }
+    return results;
+}
+
+Order* BookingService::findOrderById(int orderId) {
+    lock_guard<recursive_mutex> guard(ordersMutex);
+    auto it = orderIndex.find(orderId);
+    return it != orderIndex.end() ? &orders[it->second] : nullptr;
+}
+
+const Order* BookingService::findOrderById(int orderId) const {
+    lock_guard<recursive_mutex> guard(ordersMutex);
+    auto it = orderIndex.find(orderId);
+    return it != orderIndex.end() ? &orders[it->second] : nullptr;
+}
+
+vector<Order> BookingService::getOrdersByStaff(int staffId) const {
+    vector<Order> results;
+    for (const Order* order : findOrdersByStaff(staffId)) {
+        results.push_back(*order);
+    }
+    return results;
+}
+
+vector<Order> BookingService::getOrdersByShowtime(int showtimeId) const {
+    vector<Order> results;
+    for (const Order* order : findOrdersByShowtime(showtimeId)) {
+        results.push_back(*order);
+    }
+    return results;
+}
+
+vector<const Order*> BookingService::findOrdersByStaff(int staffId) const {
+    lock_guard<recursive_mutex> guard(ordersMutex);
+    auto it = ordersByStaff.find(staffId);
+    return collectOrders(it != ordersByStaff.end() ? &it->second : nullptr);
+}
+
+vector<const Order*> BookingService::findOrdersByShowtime(int showtimeId) const {
+    lock_guard<recursive_mutex> guard(ordersMutex);
+    auto it = ordersByShowtime.find(showtimeId);
+    return collectOrders(it != ordersByShowtime.end() ? &it->second : nullptr);
+}
+
+vector<const Order*> BookingService::findOrdersByPhone(const string& customerPhone) const {
+    lock_guard<recursive_mutex> guard(ordersMutex);
+    auto it = ordersByPhone.find(customerPhone);
+    return collectOrders(it != ordersByPhone.end() ? &it->second : nullptr);
+}
+
+// A phone number is looked up in the index; anything else is matched against the customer names.
+// Copies are taken under the lock, so the results stay consistent while terminals keep booking.
+vector<Order> BookingService::getOrdersByCustomer(const string& query, size_t limit, const atomic<bool>* canceled) const {
+    vector<Order> results;
+    lock_guard<recursive_mutex> guard(ordersMutex);
+    auto it = ordersByPhone.find(query);
+    if (it != ordersByPhone.end()) {
+        for (auto slot = it->second.rbegin(); slot != it->second.rend() && results.size() < limit; ++slot) {
+            results.push_back(orders[*slot]);
+        }
+        return results;
+    }
+    
+    string lowerQuery = query;
+    transform(lowerQuery.begin(), lowerQuery.end(), lowerQuery.begin(), ::tolower);
+    if (lowerQuery.empty()) {
+        return results;
+    }
+    string name;
+    for (auto order = orders.rbegin(); order != orders.rend() && results.size() < limit; ++order) {
+        if (canceled && *canceled) {
+            break;
+        }
+        name = order->getCustomerName();
+        transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (name.find(lowerQuery) != string::npos) {
+            results.push_back(*order);
+        }
+    }
+    return results;
+}
+
+int BookingService::getOrderCount() const {
+    lock_guard<recursive_mutex> guard(ordersMutex);
+    return orders.size();
+}
+
+bool BookingService::confirmBooking(int orderId) {
+    uint64_t lsn;
+    {
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        Order* order = findOrderById(orderId);
+        if (!order) {
+            cout << "Error: Order not found!" << endl;
+            return false;
+        }
+        
+        if (!canTransition(order->getPaymentStatus(), OrderPaymentStatus::PAID)) {
+            cout << "Error: Cannot confirm a " << toString(order->getPaymentStatus()) << " order!" << endl;
+            return false;
+        }
+        
+        // Mark seats as sold, unless a seat's hold expired and another order took it
+        int sold = sellOrderSeats(order->getShowtimeId(), order->getSeatIds(), orderId);
+        if (sold < 0) {
+            cout << "Error: Some seats of this order are no longer available!" << endl;
+            return false;
+        }
+        publishSoldSeats(order->getShowtimeId(), sold);
+        
+        order->setPaymentStatus(OrderPaymentStatus::PAID);
+        
+        BookingLogRecord record(BookingLog::CONFIRM_BOOKING);
+        record.putInt(orderId);
+        logRecord(record);
+        
+        // Issue tickets
+        lsn = issueTicketsFor(*order);
+    }
+    if (!syncLog(lsn)) {
+        cout << "Error: Booking log write failed!" << endl;
+        return false;
+    }
+    
+    cout << "Tickets issued successfully!" << endl;
+    cout << "Booking confirmed successfully!" << endl;
+    return true;
+}
+
+bool BookingService::cancelBooking(int orderId, const string& reason) {
+    uint64_t lsn = 0;
+    vector<SeatClaim> released;
+    OrderPaymentStatus previousStatus;
+    {
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        Order* order = findOrderById(orderId);
+        if (!order) {
+            cout << "Error: Order not found!" << endl;
+            return false;
+        }
+        
+        if (!canTransition(order->getPaymentStatus(), OrderPaymentStatus::CANCELED)) {
+            cout << "Error: Cannot cancel a " << toString(order->getPaymentStatus()) << " order!" << endl;
+            return false;
+        }
+        
+        // Release seats and log the cancel before anyone can claim them
+        previousStatus = order->getPaymentStatus();
+        auto logCancel = [this, order, &lsn]() {
+            order->setPaymentStatus(OrderPaymentStatus::CANCELED);
+            BookingLogRecord record(BookingLog::CANCEL_BOOKING);
+            record.putInt(order->getId());
+            lsn = logRecord(record);
+        };
+        publishSoldSeats(order->getShowtimeId(), 
+                         -releaseOrderSeats(order->getShowtimeId(), order->getSeatIds(), orderId, &released, logCancel));
+    }
+    if (!syncLog(lsn)) {
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        undoOrderRelease(*findOrderById(orderId), released, previousStatus);
+        cout << "Error: Booking log write failed!" << endl;
+        return false;
+    }
+    
+    cout << "Booking canceled. Reason: " << reason << endl;
+    return true;
+}
+
+bool BookingService::exchangeTicket(int orderId, int newShowtimeId, const vector<string>& newSeatIds) {
+    uint64_t lsn = 0;
+    vector<SeatClaim> released;
+    int oldShowtimeId;
+    vector<string> oldOrderSeatIds;
+    vector<string> addedSeatIds;
+    {
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        Order* order = findOrderById(orderId);
+        if (!order) {
+            cout << "Error: Order not found!" << endl;
+            return false;
+        }
+        
+        if (order->getPaymentStatus() != OrderPaymentStatus::PENDING && 
+            order->getPaymentStatus() != OrderPaymentStatus::PAID) {
+            cout << "Error: Cannot exchange a " << toString(order->getPaymentStatus()) << " order!" << endl;
+            return false;
+        }
+        
+        if (newSeatIds.empty()) {
+            cout << "Error: No seats selected!" << endl;
+            return false;
+        }
+        
+        // Hold new seats first so a failed exchange keeps the old ones
+        addedSeatIds = addedSeats(*order, newShowtimeId, newSeatIds);
+        int holdTimeSeconds = 0;
+        time_t holdExpiry = 0;
+        string error;
+        if (!addedSeatIds.empty() && 
+            !acquireSeats(newShowtimeId, addedSeatIds, holdTimeSeconds, orderId, holdExpiry, error)) {
+            cout << "Error: " << error << endl;
+            return false;
+        }
+        
+        // A paid order keeps its new seats sold
+        if (order->getPaymentStatus() == OrderPaymentStatus::PAID) {
+            publishSoldSeats(newShowtimeId, max(sellOrderSeats(newShowtimeId, addedSeatIds, orderId), 0));
+        }
+        
+        // Release old seats, then update the order and log the exchange before anyone can claim them
+        oldShowtimeId = order->getShowtimeId();
+        oldOrderSeatIds = order->getSeatIds();
+        vector<string> oldSeatIds = exchangedSeats(*order, newShowtimeId, newSeatIds);
+        auto logExchange = [this, order, orderId, newShowtimeId, &newSeatIds, holdExpiry, &lsn]() {
+            size_t slot = orderIndex[orderId];
+            unindexOrder(slot);
+            order->setShowtimeId(newShowtimeId);
+            order->setSeatIds(newSeatIds);
+            indexOrder(slot);
+            
+            BookingLogRecord record(BookingLog::EXCHANGE_TICKET);
+            record.putInt(orderId);
+            record.putInt(newShowtimeId);
+            record.putInt(holdExpiry);
+            record.putStrings(newSeatIds);
+            lsn = logRecord(record);
+        };
+        publishSoldSeats(oldShowtimeId, -releaseOrderSeats(oldShowtimeId, oldSeatIds, orderId, &released, logExchange));
+    }
+    if (!syncLog(lsn)) {
+        // Give up the seats just acquired, take back the old ones and point the order at them again
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        Order* order = findOrderById(orderId);
+        publishSoldSeats(newShowtimeId, -releaseOrderSeats(newShowtimeId, addedSeatIds, orderId));
+        size_t slot = orderIndex[orderId];
+        unindexOrder(slot);
+        order->setShowtimeId(oldShowtimeId);
+        order->setSeatIds(oldOrderSeatIds);
+        indexOrder(slot);
+        undoOrderRelease(*order, released, order->getPaymentStatus());
+        cout << "Error: Booking log write failed!" << endl;
+        return false;
+    }
+    
+    cout << "Ticket exchanged successfully!" << endl;
+    return true;
+}
+
+bool BookingService::refundTicket(int orderId, const string& reason) {
+    uint64_t lsn = 0;
+    vector<SeatClaim> released;
+    vector<size_t> canceledTickets;
+    OrderPaymentStatus previousStatus;
+    {
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        Order* order = findOrderById(orderId);
+        if (!order) {
+            cout << "Error: Order not found!" << endl;
+            return false;
+        }
+        
+        if (!canTransition(order->getPaymentStatus(), OrderPaymentStatus::REFUNDED)) {
+            cout << "Error: Cannot refund a " << toString(order->getPaymentStatus()) << " order!" << endl;
+            return false;
+        }
+        
+        // Release seats, cancel the tickets and log the refund before anyone can claim the seats
+        previousStatus = order->getPaymentStatus();
+        auto logRefund = [this, order, &lsn, &canceledTickets]() {
+            order->setPaymentStatus(OrderPaymentStatus::REFUNDED);
+            canceledTickets = cancelTicketsOfOrder(order->getId());
+            BookingLogRecord record(BookingLog::REFUND_TICKET);
+            record.putInt(order->getId());
+            lsn = logRecord(record);
+        };
+        publishSoldSeats(order->getShowtimeId(), 
+                         -releaseOrderSeats(order->getShowtimeId(), order->getSeatIds(), orderId, &released, logRefund));
+    }
+    if (!syncLog(lsn)) {
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        undoOrderRelease(*findOrderById(orderId), released, previousStatus);
+        restoreTickets(canceledTickets);
+        cout << "Error: Booking log write failed!" << endl;
+        return false;
+    }
+    
+    cout << "Ticket refunded. Reason: " << reason << endl;
+    return true;
+}
+
+bool BookingService::issueTickets(int orderId) {
+    uint64_t lsn;
+    {
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        Order* order = findOrderById(orderId);
+        if (!order) {
+            cout << "Error: Order not found!" << endl;
+            return false;
+        }
+        lsn = issueTicketsFor(*order);
+    }
+    if (!syncLog(lsn)) {
+        cout << "Error: Booking log write failed!" << endl;
+        return false;
+    }
+    
+    cout << "Tickets issued successfully!" << endl;
+    return true;
+}
+
+// Caller holds ordersMutex; returns the log position of the ISSUE_TICKETS record
+uint64_t BookingService::issueTicketsFor(const Order& order) {
+    vector<string> ticketIds;
+    for (size_t i = 0; i < order.getSeatIds().size(); i++) {
+        ticketIds.push_back(allocateTicketId());
+    }
+    {
+        lock_guard<mutex> ticketsGuard(ticketsMutex);
+        addTickets(order, ticketIds);
+    }
+    
+    BookingLogRecord record(BookingLog::ISSUE_TICKETS);
+    record.putInt(order.getId());
+    record.putStrings(ticketIds);
+    return logRecord(record);
+}
+
+// Caller holds ticketsMutex
+void BookingService::addTickets(const Order& order, const vector<string>& ticketIds) {
+    vector<string> seatIds = order.getSeatIds();
+    for (size_t i = 0; i < seatIds.size() && i < ticketIds.size(); i++) {
+        Ticket ticket(order.getId(), order.getShowtimeId(), seatIds[i]);
+        ticket.setTicketId(ticketIds[i]);
+        ticket.setMovieTitle("Sample Movie"); // Would get from movie service
+        ticket.setAuditoriumName("Theater 1"); // Would get from showtime service
+        ticket.setShowTime(timeSource.now() + 3600); // Sample show time
+        ticket.setPrice(12.0); // Would calculate based on seat type
+        
+        tickets.push_back(ticket);
+        ticketIndex[ticket.getTicketId()] = tickets.size() - 1;
+        ticketsByOrder[order.getId()].push_back(tickets.size() - 1);
     }
-    return nullptr;
 }
 
-vector<Order> BookingService::getOrdersByStaff(int staffId) const {
-    vector<Order> results;
-    for (const auto& order : orders) {
-        if (order.getStaffId() == staffId) {
-            results.push_back(order);
+vector<size_t> BookingService::cancelTicketsOfOrder(int orderId) {
+    lock_guard<mutex> ticketsGuard(ticketsMutex);
+    vector<size_t> canceled;
+    auto it = ticketsByOrder.find(orderId);
+    if (it != ticketsByOrder.end()) {
+        for (size_t slot : it->second) {
+            if (tickets[slot].setStatus(TicketStatus::CANCELED)) {
+                canceled.push_back(slot);
+            }
         }
     }
-    return results;
+    return canceled;
 }
 
-vector<Order> BookingService::getOrdersByShowtime(int showtimeId) const {
-    vector<Order> results;
-    for (const auto& order : orders) {
-        if (order.getShowtimeId() == showtimeId) {
-            results.push_back(order);
-        }
+void BookingService::restoreTickets(const vector<size_t>& slots) {
+    lock_guard<mutex> ticketsGuard(ticketsMutex);
+    for (size_t slot : slots) {
+        tickets[slot].loadStatus(TicketStatus::VALID);
     }
-    return results;
 }
 
-bool BookingService::confirmBooking(int orderId) {
-    Order* order = findOrderById(orderId);
-    if (!order) {
-        cout << "Error: Order not found!" << endl;
-        return false;
+// Write-ahead log: records are appended under the locks that ordered the change,
+// then the caller waits for durability after releasing them
+uint64_t BookingService::logRecord(const BookingLogRecord& record) {
+    return bookingLog.append(record); // 0 when no log is open
+}
+
+bool BookingService::syncLog(uint64_t lsn) {
+    return lsn == 0 || bookingLog.commit(lsn);
+}
+
+void BookingService::writeOrder(BookingLogRecord& record, const Order& order) {
+    record.putInt(order.getId());
+    record.putInt(order.getStaffId());
+    record.putInt(order.getShowtimeId());
+    record.putStrings(order.getSeatIds());
+    record.putDouble(order.getSubtotal());
+    record.putDouble(order.getTax());
+    record.putDouble(order.getDiscount());
+    record.putDouble(order.getTotalAmount());
+    record.putString(toString(order.getPaymentStatus()));
+    record.putString(order.getCustomerName());
+    record.putString(order.getCustomerPhone());
+}
+
+Order BookingService::readOrder(BookingLogReader& reader) {
+    Order order;
+    order.setId((int)reader.getInt());
+    order.setStaffId((int)reader.getInt());
+    order.setShowtimeId((int)reader.getInt());
+    order.setSeatIds(reader.getStrings());
+    order.setSubtotal(reader.getDouble());
+    order.setTax(reader.getDouble());
+    order.setDiscount(reader.getDouble());
+    order.setTotalAmount(reader.getDouble());
+    OrderPaymentStatus paymentStatus = OrderPaymentStatus::PENDING;
+    parseStatus(reader.getString(), paymentStatus);
+    order.loadPaymentStatus(paymentStatus);
+    order.setCustomerName(reader.getString());
+    order.setCustomerPhone(reader.getString());
+    return order;
+}
+
+// Re-holds seats with their original expiry; holds that ran out while the system was down are dropped
+void BookingService::restoreHold(int showtimeId, const vector<string>& seatIds, time_t holdExpiry, int orderId) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard || holdExpiry < timeSource.now()) {
+        return;
     }
     
-    // Mark seats as sold
-    vector<Seat>& seats = showtimeSeats[order->getShowtimeId()];
-    for (const string& seatId : order->getSeatIds()) {
-        for (Seat& seat : seats) {
-            if (seat.getSeatId() == seatId) {
-                seat.setStatus("sold");
-                seat.setOrderId(orderId);
-                break;
-            }
+    lock_guard<mutex> guard(shard->lock);
+    vector<uint64_t> mask;
+    string unknownSeatId;
+    shard->seats.buildMask(seatIds, mask, unknownSeatId);
+    holdSeatsUntil(*shard, showtimeId, mask, holdExpiry, orderId);
+}
+
+// Applies one record to memory without logging it again
+bool BookingService::replayRecord(const string& payload) {
+    BookingLogReader reader(payload);
+    uint8_t type = reader.getType();
+    
+    if (type == BookingLog::HOLD_SEATS || type == BookingLog::RELEASE_SEATS) {
+        int showtimeId = (int)reader.getInt();
+        time_t holdExpiry = type == BookingLog::HOLD_SEATS ? (time_t)reader.getInt() : 0;
+        vector<string> seatIds = reader.getStrings();
+        if (!reader.isOk()) {
+            return false;
+        }
+        if (type == BookingLog::HOLD_SEATS) {
+            restoreHold(showtimeId, seatIds, holdExpiry, 0);
+        } else {
+            releaseSeats(showtimeId, seatIds);
         }
+        return true;
     }
     
-    order->setPaymentStatus("paid");
-    
-    // Issue tickets
-    issueTickets(orderId);
+    if (type == BookingLog::CREATE_ORDER || type == BookingLog::UPDATE_ORDER) {
+        Order order = readOrder(reader);
+        time_t holdExpiry = type == BookingLog::CREATE_ORDER ? (time_t)reader.getInt() : 0;
+        if (!reader.isOk()) {
+            return false;
+        }
+        
+        lock_guard<recursive_mutex> guard(ordersMutex);
+        auto it = orderIndex.find(order.getId());
+        if (it == orderIndex.end()) {
+            orders.push_back(order);
+            indexOrder(orders.size() - 1);
+        } else {
+            unindexOrder(it->second);
+            orders[it->second] = order;
+            indexOrder(it->second);
+        }
+        if (order.getId() >= nextOrderId) {
+            nextOrderId = order.getId() + 1;
+        }
+        if (type == BookingLog::CREATE_ORDER) {
+            restoreHold(order.getShowtimeId(), order.getSeatIds(), holdExpiry, order.getId());
+        }
+        return true;
+    }
     
-    cout << "Booking confirmed successfully!" << endl;
-    return true;
-}
-
-bool BookingService::cancelBooking(int orderId, const string& reason) {
+    int orderId = (int)reader.getInt();
+    lock_guard<recursive_mutex> guard(ordersMutex);
     Order* order = findOrderById(orderId);
-    if (!order) {
-        cout << "Error: Order not found!" << endl;
+    if (!reader.isOk() || !order) {
         return false;
     }
     
-    // Release seats
-    releaseHeldSeats(order->getShowtimeId(), order->getSeatIds());
-    
-    order->setPaymentStatus("canceled");
-    
-    cout << "Booking canceled. Reason: " << reason << endl;
+    if (type == BookingLog::CONFIRM_BOOKING) {
+        publishSoldSeats(order->getShowtimeId(), 
+                         max(sellOrderSeats(order->getShowtimeId(), order->getSeatIds(), orderId), 0));
+        order->setPaymentStatus(OrderPaymentStatus::PAID);
+    } else if (type == BookingLog::CANCEL_BOOKING || type == BookingLog::REFUND_TICKET) {
+        publishSoldSeats(order->getShowtimeId(), 
+                         -releaseOrderSeats(order->getShowtimeId(), order->getSeatIds(), orderId));
+        if (type == BookingLog::CANCEL_BOOKING) {
+            order->setPaymentStatus(OrderPaymentStatus::CANCELED);
+        } else {
+            order->setPaymentStatus(OrderPaymentStatus::REFUNDED);
+            cancelTicketsOfOrder(orderId);
+        }
+    } else if (type == BookingLog::EXCHANGE_TICKET) {
+        int newShowtimeId = (int)reader.getInt();
+        time_t holdExpiry = (time_t)reader.getInt();
+        vector<string> newSeatIds = reader.getStrings();
+        if (!reader.isOk()) {
+            return false;
+        }
+        vector<string> addedSeatIds = addedSeats(*order, newShowtimeId, newSeatIds);
+        restoreHold(newShowtimeId, addedSeatIds, holdExpiry, orderId);
+        if (order->getPaymentStatus() == OrderPaymentStatus::PAID) {
+            publishSoldSeats(newShowtimeId, max(sellOrderSeats(newShowtimeId, addedSeatIds, orderId), 0));
+        }
+        vector<string> oldSeatIds = exchangedSeats(*order, newShowtimeId, newSeatIds);
+        publishSoldSeats(order->getShowtimeId(), 
+                         -releaseOrderSeats(order->getShowtimeId(), oldSeatIds, orderId));
+        
+        size_t slot = orderIndex[orderId];
+        unindexOrder(slot);
+        order->setShowtimeId(newShowtimeId);
+        order->setSeatIds(newSeatIds);
+        indexOrder(slot);
+    } else if (type == BookingLog::ISSUE_TICKETS) {
+        vector<string> ticketIds = reader.getStrings();
+        if (!reader.isOk()) {
+            return false;
+        }
+        lock_guard<mutex> ticketsGuard(ticketsMutex);
+        addTickets(*order, ticketIds);
+        
+        // Serials are "TKT" + number; new blocks must start past every recovered serial
+        for (const string& ticketId : ticketIds) {
+            int serial = atoi(ticketId.c_str() + min<size_t>(3, ticketId.size()));
+            int block = (serial - 1) / TICKET_ID_BLOCK_SIZE + 1;
+            if (block > nextTicketBlock) {
+                nextTicketBlock = block;
+            }
+        }
+    } else {
+        return false;
+    }
     return true;
 }
 
-bool BookingService::exchangeTicket(int orderId, int newShowtimeId, const vector<string>& newSeatIds) {
-    Order* order = findOrderById(orderId);
-    if (!order) {
-        cout << "Error: Order not found!" << endl;
-        return false;
-    }
+bool BookingService::openLog(const string& path, bool groupCommit) {
+    closeLog();
     
-    if (!validateSeatSelection(newShowtimeId, newSeatIds)) {
+    vector<string> payloads;
+    string error;
+    if (!BookingLog::readRecords(path, payloads, error)) {
+        cout << "Error: " << error << endl;
         return false;
     }
     
-    // Release old seats
-    releaseHeldSeats(order->getShowtimeId(), order->getSeatIds());
-    
-    // Hold new seats
-    if (!holdSeats(newShowtimeId, newSeatIds)) {
-        return false;
+    int skipped = 0;
+    for (const string& payload : payloads) {
+        if (!replayRecord(payload)) {
+            skipped++;
+        }
     }
     
-    // Update order
-    order->setShowtimeId(newShowtimeId);
-    order->setSeatIds(newSeatIds);
-    
-    cout << "Ticket exchanged successfully!" << endl;
-    return true;
-}
-
-bool BookingService::refundTicket(int orderId, const string& reason) {
-    Order* order = findOrderById(orderId);
-    if (!order) {
-        cout << "Error: Order not found!" << endl;
+    if (!bookingLog.open(path, groupCommit, error)) {
+        cout << "Error: " << error << endl;
         return false;
     }
     
-    // Release seats
-    releaseHeldSeats(order->getShowtimeId(), order->getSeatIds());
-    
-    order->setPaymentStatus("refunded");
-    
-    // Mark tickets as canceled
-    for (auto& ticket : tickets) {
-        if (ticket.getOrderId() == orderId) {
-            ticket.setStatus("canceled");
+    if (!payloads.empty()) {
+        cout << "Recovered " << payloads.size() - skipped << " booking log records";
+        if (skipped > 0) {
+            cout << " (" << skipped << " skipped)";
         }
+        cout << "." << endl;
     }
-    
-    cout << "Ticket refunded. Reason: " << reason << endl;
     return true;
 }
 
-bool BookingService::issueTickets(int orderId) {
-    Order* order = findOrderById(orderId);
-    if (!order) {
-        cout << "Error: Order not found!" << endl;
-        return false;
-    }
-    
-    for (const string& seatId : order->getSeatIds()) {
-        Ticket ticket(orderId, order->getShowtimeId(), seatId);
-        ticket.setMovieTitle("Sample Movie"); // Would get from movie service
-        ticket.setAuditoriumName("Theater 1"); // Would get from showtime service
-        ticket.setShowTime(time(0) + 3600); // Sample show time
-        ticket.setPrice(12.0); // Would calculate based on seat type
-        
-        tickets.push_back(ticket);
+void BookingService::closeLog() {
+    bookingLog.close();
+}
+
+// Unique by construction: a thread takes a block of serials with one atomic add
+// and then numbers its tickets from that block without touching shared state
+string BookingService::allocateTicketId() {
+    struct TicketIdBlock {
+        unsigned long long owner;
+        int next;
+        int end;
+    };
+    static thread_local TicketIdBlock block = {0, 0, 0};
+    
+    if (block.owner != instanceId || block.next == block.end) {
+        int start = nextTicketBlock.fetch_add(1) * TICKET_ID_BLOCK_SIZE + 1;
+        block.owner = instanceId;
+        block.next = start;
+        block.end = start + TICKET_ID_BLOCK_SIZE;
     }
-    
-    cout << "Tickets issued successfully!" << endl;
-    return true;
+    return Ticket::generateTicketId(block.next++);
 }
 
 vector<Ticket> BookingService::getTicketsByOrder(int orderId) const {
+    lock_guard<mutex> guard(ticketsMutex);
     vector<Ticket> results;
-    for (const auto& ticket : tickets) {
-        if (ticket.getOrderId() == orderId) {
-            results.push_back(ticket);
+    auto it = ticketsByOrder.find(orderId);
+    if (it != ticketsByOrder.end()) {
+        for (size_t slot : it->second) {
+            results.push_back(tickets[slot]);
         }
     }
     return results;
 }
 
 Ticket* BookingService::findTicketById(const string& ticketId) {
-    for (auto& ticket : tickets) {
-        if (ticket.getTicketId() == ticketId) {
-            return &ticket;
-        }
+    lock_guard<mutex> guard(ticketsMutex);
+    auto it = ticketIndex.find(ticketId);
+    return it != ticketIndex.end() ? &tickets[it->second] : nullptr;
+}
+
+bool BookingService::getTicketById(const string& ticketId, Ticket& ticket) const {
+    lock_guard<mutex> guard(ticketsMutex);
+    auto it = ticketIndex.find(ticketId);
+    if (it == ticketIndex.end()) {
+        return false;
     }
-    return nullptr;
+    ticket = tickets[it->second];
+    return true;
 }
 
 bool BookingService::validateTicket(const string& ticketId) const {
-    for (const auto& ticket : tickets) {
-        if (ticket.getTicketId() == ticketId) {
-            return ticket.isValid();
-        }
-    }
-    return false;
+    lock_guard<mutex> guard(ticketsMutex);
+    auto it = ticketIndex.find(ticketId);
+    return it != ticketIndex.end() && tickets[it->second].isValid();
 }
 
 double BookingService::calculateOrderTotal(int showtimeId, const vector<string>& seatIds, 
                                           double basePrice, double taxRate, double discount) const {
-    double subtotal = 0.0;
+    // Layouts are immutable once compiled, so prices are read without holding the shard
+    shared_ptr<const SeatLayout> layout;
+    SeatShard* shard = findShard(showtimeId);
+    if (shard) {
+        lock_guard<mutex> guard(shard->lock);
+        layout = shard->seats.getSharedLayout();
+    }
     
+    double subtotal = 0.0;
     for (const string& seatId : seatIds) {
-        subtotal += calculateSeatPrice(seatId, basePrice);
+        subtotal += calculateSeatPrice(layout.get(), seatId, basePrice);
     }
     
     double tax = subtotal * taxRate;
@@ -524,56 +2392,68 @@ double BookingService::calculateOrderTotal(int showtimeId, const vector<string>&
 }
 
 void BookingService::displaySeatMap(int showtimeId) const {
-    if (showtimeSeats.find(showtimeId) == showtimeSeats.end()) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
         cout << "No seat map available for showtime " << showtimeId << endl;
         return;
     }
     
-    const vector<Seat>& seats = showtimeSeats.at(showtimeId);
+    lock_guard<mutex> guard(shard->lock);
+    const SeatStateMap& seats = shard->seats;
+    const SeatLayout& layout = seats.getLayout();
+    time_t now = timeSource.now();
     
     cout << "\n=== SEAT MAP FOR SHOWTIME " << showtimeId << " ===" << endl;
     cout << "Legend: [A] Available, [H] Held, [X] Sold" << endl;
     cout << "        SCREEN" << endl;
     cout << "======================" << endl;
     
-    string currentRow = "";
-    for (const auto& seat : seats) {
-        if (seat.getRow() != currentRow) {
-            if (!currentRow.empty()) cout << endl;
-            currentRow = seat.getRow();
-            cout << currentRow << ": ";
-        }
+    for (int row = 0; row < layout.getRowCount(); row++) {
+        int rowStart = layout.getRowStart(row);
+        cout << layout.getRowLabel(row) << ": ";
         
-        if (seat.isAvailable()) {
-            cout << "[A]";
-        } else if (seat.isHeld()) {
-            cout << "[H]";
-        } else if (seat.isSold()) {
-            cout << "[X]";
+        int column = 0;
+        for (int ordinal = rowStart; ordinal < layout.getRowEnd(row); ordinal++) {
+            for (; column < layout.getColumn(ordinal); column++) {
+                cout << "    "; // Aisle or gap
+            }
+            column++;
+            
+            if (seats.isAvailable(ordinal)) {
+                cout << "[A]";
+            } else if (seats.isHeld(ordinal) && now <= seats.getHoldExpiresAt(ordinal)) {
+                cout << "[H]";
+            } else if (seats.isSold(ordinal)) {
+                cout << "[X]";
+            }
+            cout << " ";
         }
-        cout << " ";
+        cout << endl;
     }
-    cout << endl;
 }
 
 void BookingService::displayAvailableSeats(int showtimeId) const {
-    if (showtimeSeats.find(showtimeId) == showtimeSeats.end()) {
+    SeatShard* shard = findShard(showtimeId);
+    if (!shard) {
         cout << "No seats available for showtime " << showtimeId << endl;
         return;
     }
     
-    const vector<Seat>& seats = showtimeSeats.at(showtimeId);
+    lock_guard<mutex> guard(shard->lock);
+    const SeatStateMap& seats = shard->seats;
+    const SeatLayout& layout = seats.getLayout();
     
     cout << "\n=== AVAILABLE SEATS ===" << endl;
-    for (const auto& seat : seats) {
-        if (seat.isAvailable()) {
-            cout << seat.getSeatId() << "(" << seat.getType() << ") ";
+    for (int ordinal = 0; ordinal < seats.getSeatCount(); ordinal++) {
+        if (seats.isAvailable(ordinal)) {
+            cout << layout.getSeatId(ordinal) << "(" << layout.getType(ordinal) << ") ";
         }
     }
     cout << endl;
 }
 
 void BookingService::displayAllOrders() const {
+    lock_guard<recursive_mutex> guard(ordersMutex);
     cout << "\n=== ALL ORDERS ===" << endl;
     for (const auto& order : orders) {
         order.displayInfo();
@@ -583,17 +2463,14 @@ void BookingService::displayAllOrders() const {
 
 void BookingService::displayOrderHistory(int staffId) const {
     cout << "\n=== ORDER HISTORY FOR STAFF " << staffId << " ===" << endl;
-    vector<Order> staffOrders = getOrdersByStaff(staffId);
-    for (const auto& order : staffOrders) {
-        order.displayInfo();
+    for (const Order* order : findOrdersByStaff(staffId)) {
+        order->displayInfo();
         cout << "---" << endl;
     }
 }
 
 string BookingService::formatTime(time_t timeValue) const {
-    char buffer[80];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", localtime(&timeValue));
-    return string(buffer);
+    return TimeService::formatDateTime(timeValue);
 }
 
 void BookingService::printTicketToFile(const Ticket& ticket, const string& filename) const {
@@ -652,17 +2529,30 @@ void BookingService::selectSeatsDemo() {
     displaySeatMap(showtimeId);
     displayAvailableSeats(showtimeId);
     
-    cout << "Enter seat IDs (comma-separated, e.g., A01,A02): ";
+    cout << "Enter seat IDs (comma-separated, e.g., A01,A02) or a number of seats for best available: ";
     string seatInput;
     cin.ignore();
     getline(cin, seatInput);
     
     // Parse seat IDs
     vector<string> seatIds;
-    stringstream ss(seatInput);
-    string seat;
-    while (getline(ss, seat, ',')) {
-        seatIds.push_back(seat);
+    if (!seatInput.empty() && isdigit(seatInput[0])) {
+        seatIds = findBestSeats(showtimeId, atoi(seatInput.c_str()));
+        if (seatIds.empty()) {
+            cout << "Not enough seats available!" << endl;
+            return;
+        }
+        cout << "Best available:";
+        for (const string& seatId : seatIds) {
+            cout << " " << seatId;
+        }
+        cout << endl;
+    } else {
+        stringstream ss(seatInput);
+        string seat;
+        while (getline(ss, seat, ',')) {
+            seatIds.push_back(seat);
+        }
     }
     
     if (holdSeats(showtimeId, seatIds)) {
@@ -687,12 +2577,16 @@ void BookingService::calculatePriceDemo() {
 void BookingService::printTicketDemo() {
     cout << "\n=== PRINT TICKET ===" << endl;
     
-    if (tickets.empty()) {
-        cout << "No tickets available to print!" << endl;
-        return;
+    Ticket ticket;
+    {
+        lock_guard<mutex> guard(ticketsMutex);
+        if (tickets.empty()) {
+            cout << "No tickets available to print!" << endl;
+            return;
+        }
+        ticket = tickets[0];
     }
     
-    const Ticket& ticket = tickets[0];
     ticket.displayTicket();
     
     cout << "Print to file? (y/n): ";
@@ -741,3 +2635,712 @@ void BookingService::refundTicketDemo() {
         cout << "Ticket refunded successfully!" << endl;
     }
 }
+
+// Stress test: many terminals hold seats of one popular showtime at the same time
+void BookingService::concurrentBookingDemo() {
+    cout << "\n=== CONCURRENT BOOKING STRESS TEST ===" << endl;
+    bool holdsOk = concurrentHoldCheck();
+    bool salesOk = concurrentSalesCheck();
+    cout << (holdsOk && salesOk ? "All booking invariants held." : "Error: Booking invariants were broken!") << endl;
+}
+
+// Mutes cout while the checks drive calls that report every step; its state comes back on restore() or scope exit
+class QuietConsole {
+private:
+    ios::iostate saved;
+    bool muted;
+
+public:
+    QuietConsole() : saved(cout.rdstate()), muted(true) { cout.setstate(ios::badbit); }
+    ~QuietConsole() { restore(); }
+    
+    void restore() {
+        if (muted) {
+            cout.clear(saved);
+            muted = false;
+        }
+    }
+};
+
+// Stress check: terminals hold blocks of seats of one showtime; every seat may be won by one terminal only
+bool BookingService::concurrentHoldCheck() {
+    const int terminalCount = 8;
+    const int attemptsPerTerminal = 5000;
+    const int showtimeId = 2; // 150 seats in the sample data
+    
+    BookingService service; // Fresh seat maps, this service's seats are untouched
+    vector<Seat> seats = service.getSeatsForShowtime(showtimeId);
+    vector<vector<string>> claims(terminalCount);
+    vector<thread> terminals;
+    
+    for (int t = 0; t < terminalCount; t++) {
+        terminals.push_back(thread([&service, &seats, &claims, t, showtimeId]() {
+            minstd_rand random(t + 1);
+            for (int attempt = 0; attempt < attemptsPerTerminal; attempt++) {
+                // Ask for 1-4 neighbouring seats, like a small group at the counter
+                int count = 1 + random() % 4;
+                int first = random() % (seats.size() - count + 1);
+                vector<string> seatIds;
+                for (int i = 0; i < count; i++) {
+                    seatIds.push_back(seats[first + i].getSeatId());
+                }
+                
+                if (service.tryHoldSeats(showtimeId, seatIds, 3600)) {
+                    claims[t].insert(claims[t].end(), seatIds.begin(), seatIds.end());
+                }
+            }
+        }));
+    }
+    for (auto& terminal : terminals) {
+        terminal.join();
+    }
+    
+    // Every seat must be claimed by exactly one terminal
+    map<string, int> claimCount;
+    int totalClaimed = 0;
+    int doubleClaims = 0;
+    for (const auto& terminalClaims : claims) {
+        for (const string& seatId : terminalClaims) {
+            if (++claimCount[seatId] > 1) {
+                doubleClaims++;
+            }
+            totalClaimed++;
+        }
+    }
+    
+    int heldSeats = 0;
+    time_t now = service.timeSource.now();
+    for (const auto& seat : service.getSeatsForShowtime(showtimeId)) {
+        if (seat.isHeld(now)) {
+            heldSeats++;
+        }
+    }
+    
+    cout << "Holds: " << terminalCount << " terminals, " << terminalCount * attemptsPerTerminal << " attempts, " 
+         << totalClaimed << " seats claimed, " << heldSeats << " held, " << doubleClaims << " double claims" << endl;
+    if (doubleClaims != 0 || totalClaimed != heldSeats) {
+        cout << "Error: Seat holds are inconsistent!" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Stress check: terminals create, confirm, cancel and refund orders on one showtime while a simulated clock lets
+// holds run out, so expired orders lose seats to newer ones. Afterwards no seat may be sold twice, and no
+// order whose hold is still running may have lost a seat to another order.
+bool BookingService::concurrentSalesCheck() {
+    const int terminalCount = 8;
+    const int ordersPerTerminal = 1500;
+    const int showtimeId = 2;
+    const int holdTimeoutSeconds = 5;
+    
+    struct PlacedOrder {
+        int order_id;
+        time_t created_at;
+        vector<string> seat_ids;
+    };
+    
+    SimulatedClock clock(TimeService::now());
+    BookingService service(clock);
+    service.setHoldTimeout(showtimeId, holdTimeoutSeconds);
+    vector<Seat> seats = service.getSeatsForShowtime(showtimeId);
+    unordered_map<string, int> seatOrdinals;
+    for (size_t i = 0; i < seats.size(); i++) {
+        seatOrdinals[seats[i].getSeatId()] = (int)i;
+    }
+    
+    // An expired hold taken over by a newer order: canceling the old order must leave the new hold alone
+    vector<string> retaken = {seats[0].getSeatId(), seats[1].getSeatId()};
+    int expiredOrderId;
+    int retakingOrderId;
+    {
+        QuietConsole quiet;
+        service.createOrder(Order(terminalCount + 1, showtimeId, retaken));
+        clock.advance(holdTimeoutSeconds + 1);
+        service.createOrder(Order(terminalCount + 2, showtimeId, retaken));
+        expiredOrderId = service.findOrdersByStaff(terminalCount + 1).back()->getId();
+        retakingOrderId = service.findOrdersByStaff(terminalCount + 2).back()->getId();
+        service.cancelBooking(expiredOrderId);
+    }
+    vector<Seat> afterCancel = service.getSeatsForShowtime(showtimeId);
+    if (afterCancel[0].getOrderId() != retakingOrderId || afterCancel[1].getOrderId() != retakingOrderId ||
+        afterCancel[0].getStatus() != SeatStatus::HELD || afterCancel[1].getStatus() != SeatStatus::HELD) {
+        cout << "Error: Canceling order " << expiredOrderId << " released the seats of order " << retakingOrderId << endl;
+        return false;
+    }
+    
+    vector<vector<PlacedOrder>> placed(terminalCount);
+    atomic<int> lostHolds(0); // Confirms that failed although the order's hold was still running
+    vector<thread> terminals;
+    
+    QuietConsole quiet; // The order calls report every step on the console
+    for (int t = 0; t < terminalCount; t++) {
+        terminals.push_back(thread([&service, &seats, &seatOrdinals, &placed, &clock, &lostHolds, t, showtimeId]() {
+            minstd_rand random(100 + t);
+            int staffId = t + 1; // The newest order of this staff member is the one just created
+            vector<PlacedOrder> pending;
+            vector<int> paid;
+            for (int i = 0; i < ordersPerTerminal; i++) {
+                if (t == 0 && i % 20 == 0) {
+                    clock.advance(1);
+                }
+                
+                int count = 1 + random() % 4;
+                int first = random() % (seats.size() - count + 1);
+                vector<string> seatIds;
+                for (int s = 0; s < count; s++) {
+                    seatIds.push_back(seats[first + s].getSeatId());
+                }
+                
+                time_t createdAt = clock.now();
+                if (service.createOrder(Order(staffId, showtimeId, seatIds))) {
+                    int orderId = service.findOrdersByStaff(staffId).back()->getId();
+                    placed[t].push_back({orderId, createdAt, seatIds});
+                    int action = random() % 10;
+                    if (action < 4) {
+                        if (service.confirmBooking(orderId)) {
+                            paid.push_back(orderId);
+                        }
+                    } else if (action < 6) {
+                        service.cancelBooking(orderId);
+                    } else {
+                        pending.push_back(placed[t].back());
+                    }
+                }
+                
+                // Older orders are paid or canceled late, often after their hold ran out
+                if (!pending.empty() && random() % 3 == 0) {
+                    size_t k = random() % pending.size();
+                    PlacedOrder order = pending[k];
+                    pending.erase(pending.begin() + k);
+                    
+                    // The clock is read after the seats: if the hold still runs now, it ran while they were read
+                    vector<Seat> current = service.getSeatsForShowtime(showtimeId);
+                    if (clock.now() <= order.created_at + holdTimeoutSeconds) {
+                        for (const string& seatId : order.seat_ids) {
+                            const Seat& seat = current[seatOrdinals.at(seatId)];
+                            if (seat.getStatus() != SeatStatus::HELD || seat.getOrderId() != order.order_id) {
+                                lostHolds++;
+                                break;
+                            }
+                        }
+                    }
+                    
+                    if (random() % 2 == 0) {
+                        service.cancelBooking(order.order_id);
+                    } else if (service.confirmBooking(order.order_id)) {
+                        paid.push_back(order.order_id);
+                    } else if (clock.now() <= order.created_at + holdTimeoutSeconds) {
+                        lostHolds++;
+                    }
+                }
+                
+                // Refunds hand sold seats back, so the showtime never stays sold out
+                if (!paid.empty() && random() % 2 == 0) {
+                    size_t k = random() % paid.size();
+                    service.refundTicket(paid[k]);
+                    paid.erase(paid.begin() + k);
+                }
+            }
+        }));
+    }
+    for (auto& terminal : terminals) {
+        terminal.join();
+    }
+    quiet.restore();
+    time_t endTime = clock.now();
+    
+    vector<string> problems;
+    if (lostHolds > 0) {
+        problems.push_back(to_string(lostHolds.load()) + " orders lost seats to another order while their hold was running");
+    }
+    const SeatStateMap& state = service.findShard(showtimeId)->seats;
+    const SeatLayout& layout = state.getLayout();
+    vector<Seat> finalSeats = state.getSeats();
+    for (int ordinal = 0; ordinal < layout.getSeatCount(); ordinal++) {
+        if ((int)state.isAvailable(ordinal) + (int)state.isHeld(ordinal) + (int)state.isSold(ordinal) != 1) {
+            problems.push_back("seat " + layout.getSeatId(ordinal) + " is in more than one state");
+        }
+        if (finalSeats[ordinal].isSold()) {
+            const Order* owner = service.findOrderById(finalSeats[ordinal].getOrderId());
+            if (!owner || owner->getPaymentStatus() != OrderPaymentStatus::PAID) {
+                problems.push_back("seat " + layout.getSeatId(ordinal) + " is sold to an unpaid order");
+            }
+        }
+    }
+    
+    int orderCount = 0;
+    int paidCount = 0;
+    for (const auto& terminalOrders : placed) {
+        for (const PlacedOrder& placedOrder : terminalOrders) {
+            const Order* order = service.findOrderById(placedOrder.order_id);
+            OrderPaymentStatus status = order->getPaymentStatus();
+            bool holdRunning = endTime <= placedOrder.created_at + holdTimeoutSeconds;
+            orderCount++;
+            paidCount += status == OrderPaymentStatus::PAID;
+            
+            for (const string& seatId : order->getSeatIds()) {
+                const Seat& seat = finalSeats[layout.findOrdinal(seatId)];
+                bool owned = seat.getOrderId() == order->getId();
+                string where = "seat " + seatId + " of order " + to_string(order->getId());
+                if (status == OrderPaymentStatus::PAID && !(seat.isSold() && owned)) {
+                    problems.push_back(where + " is paid but not sold to it");
+                } else if (status == OrderPaymentStatus::PENDING && holdRunning && !(seat.isHeld(endTime) && owned)) {
+                    problems.push_back(where + " was freed while its hold was running");
+                } else if ((status == OrderPaymentStatus::CANCELED || status == OrderPaymentStatus::REFUNDED) && owned) {
+                    problems.push_back(where + " is still taken after " + toString(status));
+                }
+            }
+        }
+    }
+    
+    cout << "Sales: " << orderCount << " orders, " << paidCount << " paid, " 
+         << layout.getSeatCount() - state.countAvailable() << " seats taken at close" << endl;
+    for (size_t i = 0; i < problems.size() && i < 5; i++) {
+        cout << "Error: " << problems[i] << endl;
+    }
+    return problems.empty();
+}
+
+// Random holds, releases and order changes with the log open; a fresh service replaying the log must end up identical
+bool BookingService::logReplayCheck() {
+    const string path = "booking_log_check.wal";
+    const int showtimeIds[] = {1, 2};
+    remove(path.c_str());
+    
+    SimulatedClock clock(TimeService::now());
+    QuietConsole quiet; // Every operation reports on the console
+    
+    BookingService service(clock);
+    service.openLog(path);
+    minstd_rand random(2009);
+    for (int i = 0; i < 2000; i++) {
+        if (i % 50 == 0) {
+            clock.advance(60); // Some holds run out between operations
+        }
+        
+        int showtimeId = showtimeIds[random() % 2];
+        vector<Seat> seats = service.getSeatsForShowtime(showtimeId);
+        int count = 1 + random() % 3;
+        int first = random() % (seats.size() - count + 1);
+        vector<string> seatIds;
+        for (int s = 0; s < count; s++) {
+            seatIds.push_back(seats[first + s].getSeatId());
+        }
+        int orderId = service.getOrderCount() > 0 ? 1 + random() % service.getOrderCount() : 0;
+        
+        switch (random() % 8) {
+            case 0:
+                service.tryHoldSeats(showtimeId, seatIds, 30 + random() % 300);
+                break;
+            case 1:
+                service.releaseHeldSeats(showtimeId, seatIds);
+                break;
+            case 2: {
+                vector<SeatCommand> commands(1, SeatCommand(random() % 2 ? "hold" : "release", showtimeId, seatIds));
+                service.executeSeatCommands(commands);
+                break;
+            }
+            case 3:
+            case 4:
+                service.createOrder(Order(1 + random() % 5, showtimeId, seatIds));
+                break;
+            case 5:
+                service.confirmBooking(orderId);
+                break;
+            case 6:
+                service.cancelBooking(orderId);
+                break;
+            default:
+                if (random() % 2) {
+                    service.exchangeTicket(orderId, showtimeId, seatIds);
+                } else {
+                    service.refundTicket(orderId);
+                }
+                break;
+        }
+    }
+    service.closeLog();
+    
+    BookingService recovered(clock);
+    recovered.openLog(path);
+    recovered.closeLog();
+    remove(path.c_str());
+    quiet.restore();
+    
+    // Holds expire lazily, so both sides drop the ones that ran out before seats are compared
+    service.releaseExpiredHolds();
+    recovered.releaseExpiredHolds();
+    return compareReplay(service, recovered, showtimeIds, sizeof(showtimeIds) / sizeof(showtimeIds[0]));
+}
+
+bool BookingService::compareReplay(BookingService& service, BookingService& recovered, 
+                                   const int* showtimeIds, size_t showtimeCount) {
+    if (recovered.orders.size() != service.orders.size() || recovered.tickets.size() != service.tickets.size()) {
+        cout << "Error: Replay recovered " << recovered.orders.size() << " orders and " << recovered.tickets.size() 
+             << " tickets, the service had " << service.orders.size() << " and " << service.tickets.size() << endl;
+        return false;
+    }
+    for (size_t slot = 0; slot < service.orders.size(); slot++) {
+        const Order& order = service.orders[slot];
+        const Order& replayed = recovered.orders[slot];
+        if (replayed.getId() != order.getId() || replayed.getShowtimeId() != order.getShowtimeId() || 
+            replayed.getSeatIds() != order.getSeatIds() || replayed.getPaymentStatus() != order.getPaymentStatus()) {
+            cout << "Error: Order " << order.getId() << " differs after replay" << endl;
+            return false;
+        }
+    }
+    for (size_t slot = 0; slot < service.tickets.size(); slot++) {
+        const Ticket& ticket = service.tickets[slot];
+        const Ticket& replayed = recovered.tickets[slot];
+        if (replayed.getTicketId() != ticket.getTicketId() || replayed.getOrderId() != ticket.getOrderId() || 
+            replayed.getSeatId() != ticket.getSeatId() || replayed.getStatus() != ticket.getStatus()) {
+            cout << "Error: Ticket " << ticket.getTicketId() << " differs after replay" << endl;
+            return false;
+        }
+    }
+    for (size_t s = 0; s < showtimeCount; s++) {
+        int showtimeId = showtimeIds[s];
+        vector<Seat> seats = service.getSeatsForShowtime(showtimeId);
+        vector<Seat> replayed = recovered.getSeatsForShowtime(showtimeId);
+        for (size_t i = 0; i < seats.size(); i++) {
+            if (replayed[i].getStatus() != seats[i].getStatus() || replayed[i].getOrderId() != seats[i].getOrderId() || 
+                replayed[i].getHoldExpiresAt() != seats[i].getHoldExpiresAt()) {
+                cout << "Error: Seat " << seats[i].getSeatId() << " of showtime " << showtimeId 
+                     << " differs after replay" << endl;
+                return false;
+            }
+        }
+    }
+    cout << "Replay: " << service.orders.size() << " orders, " << service.tickets.size() 
+         << " tickets and every seat recovered" << endl;
+    return true;
+}
+
+// Benchmark: compile a large seat map and load it into a week of showtimes
+void BookingService::seatMapBenchmarkDemo() {
+    cout << "\n=== SEAT MAP COMPILER BENCHMARK ===" << endl;
+    
+    // 40 curved rows of 54 seats with two aisles and wheelchair spaces in the last row
+    stringstream json;
+    json << "{\"rows\": [";
+    for (int row = 0; row < 40; row++) {
+        string label = row < 26 ? string(1, 'A' + row) : string("A") + string(1, 'A' + row - 26);
+        string seats = row == 39 ? "WWWWWWWWWW_SSSSSSSSSSSSSSSSSSSSSSSSSSSSSS_WWWWWWWWWW" 
+                                 : "SSSSSSSSSSS_SSSSVVVVVVVVVVVVVVVVVVVVVVSSSS_SSSSSSSSSSSS";
+        json << (row ? "," : "") << "{\"label\": \"" << label << "\", \"offset\": " << abs(20 - row) / 5
+             << ", \"seats\": \"" << seats << "\"}";
+    }
+    json << "]}";
+    string seatMap = json.str();
+    
+    const int compileRuns = 200;
+    string error;
+    shared_ptr<const SeatLayout> layout;
+    clock_t start = clock();
+    for (int i = 0; i < compileRuns; i++) {
+        layout = SeatMapCompiler::compile(seatMap, error);
+    }
+    double compileMs = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC / compileRuns;
+    
+    if (!layout) {
+        cout << "Error: " << error << endl;
+        return;
+    }
+    
+    cout << "Seat map: " << seatMap.size() << " bytes, " << layout->getRowCount() << " rows, "
+         << layout->getSeatCount() << " seats" << endl;
+    cout << "Compile: " << fixed << setprecision(3) << compileMs << " ms per seat map" << endl;
+    
+    // Load: one auditorium, 7 days x 6 showtimes sharing the compiled layout
+    const int showtimeCount = 42;
+    BookingService service;
+    Auditorium auditorium(99, "Benchmark Hall", layout->getSeatCount());
+    auditorium.setSeatMap(seatMap);
+    
+    start = clock();
+    service.registerAuditorium(auditorium);
+    for (int i = 0; i < showtimeCount; i++) {
+        Showtime showtime(1, auditorium.getId(), 0, 0);
+        showtime.setId(1000 + i);
+        showtime.setSeatsTotal(layout->getSeatCount());
+        service.registerShowtime(showtime);
+    }
+    double loadMs = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    
+    cout << "Load: auditorium + " << showtimeCount << " showtimes in " << loadMs << " ms" << endl;
+    
+    vector<string> best = service.findBestSeats(1000, 4);
+    cout << "Best 4 seats of a fresh showtime:";
+    for (const string& seatId : best) {
+        cout << " " << seatId;
+    }
+    cout << endl;
+}
+
+// Benchmark: concurrent holds with an fsync per operation versus group commit, then recovery
+void BookingService::bookingLogBenchmarkDemo() {
+    cout << "\n=== BOOKING LOG BENCHMARK ===" << endl;
+    
+    const int terminalCount = 8;
+    const int holdsPerTerminal = 100;
+    const int showtimeId = 1;
+    const string path = "booking_log_benchmark.wal";
+    
+    Auditorium auditorium(1, "Benchmark Hall", terminalCount * holdsPerTerminal);
+    Showtime showtime(1, auditorium.getId(), 0, 0);
+    showtime.setId(showtimeId);
+    showtime.setSeatsTotal(auditorium.getCapacity());
+    
+    for (int mode = 0; mode < 2; mode++) {
+        bool groupCommit = mode == 1;
+        remove(path.c_str());
+        
+        BookingService service;
+        service.registerAuditorium(auditorium);
+        service.registerShowtime(showtime);
+        if (!service.openLog(path, groupCommit)) {
+            return;
+        }
+        vector<Seat> seats = service.getSeatsForShowtime(showtimeId);
+        
+        // Each terminal holds its own seats, so every hold succeeds and is logged
+        auto start = chrono::steady_clock::now();
+        vector<thread> terminals;
+        for (int t = 0; t < terminalCount; t++) {
+            terminals.push_back(thread([&service, &seats, t, showtimeId]() {
+                for (int i = 0; i < holdsPerTerminal; i++) {
+                    vector<string> seatIds(1, seats[t * holdsPerTerminal + i].getSeatId());
+                    service.tryHoldSeats(showtimeId, seatIds, 3600);
+                }
+            }));
+        }
+        for (auto& terminal : terminals) {
+            terminal.join();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        long syncs = service.bookingLog.getSyncCount();
+        service.closeLog();
+        
+        int operations = terminalCount * holdsPerTerminal;
+        cout << (groupCommit ? "Group commit:  " : "Fsync per op:  ") << operations << " holds in "
+             << fixed << setprecision(3) << seconds << " s (" << setprecision(0) << operations / seconds 
+             << " ops/s), " << syncs << " fsyncs" << endl;
+    }
+    
+    // Recovery: a fresh service replays the last log and gets every hold back
+    BookingService recovered;
+    recovered.registerAuditorium(auditorium);
+    recovered.registerShowtime(showtime);
+    recovered.openLog(path);
+    recovered.closeLog();
+    cout << "Seats held after recovery: " 
+         << auditorium.getCapacity() - recovered.getAvailableSeatCount(showtimeId) << endl;
+    
+    remove(path.c_str());
+    
+    if (!logReplayCheck()) {
+        cout << "Error: Replaying the booking log does not restore the service!" << endl;
+    }
+}
+
+// Orders and cash payments laid out as they were before the status enums, for the encoding benchmark
+struct StringStatusOrder {
+    int id;
+    int staff_id;
+    int showtime_id;
+    vector<string> seat_ids;
+    double subtotal;
+    double tax;
+    double discount;
+    double total_amount;
+    string payment_status; // pending, paid, canceled, refunded
+    string customer_name;
+    string customer_phone;
+    time_t created_at;
+    time_t updated_at;
+};
+
+struct StringStatusCashPayment {
+    int id;
+    int order_id;
+    double amount;
+    string status; // pending, completed, failed, refunded, voided
+    string gateway_ref;
+    time_t created_at;
+    time_t updated_at;
+    double cash_received;
+    double change_given;
+    int cashier_id;
+    
+    virtual ~StringStatusCashPayment() {} // Payment is polymorphic
+};
+
+void BookingService::statusEncodingBenchmarkDemo() {
+    cout << "\n=== STATUS ENCODING ===" << endl;
+    
+    // Both versions get the same statuses: a third each of paid/completed, canceled/failed and pending
+    const int count = 200000;
+    const int repeats = 10;
+    vector<Order> orderList(count, Order(1, 1, vector<string>(1, "A01")));
+    vector<CashPayment> paymentList(count, CashPayment(1, 10.0, 10.0, 1));
+    vector<StringStatusOrder> stringOrders(count);
+    vector<StringStatusCashPayment> stringPayments(count);
+    for (int i = 0; i < count; i++) {
+        if (i % 3 == 0) {
+            orderList[i].setPaymentStatus(OrderPaymentStatus::PAID);
+            paymentList[i].setStatus(PaymentStatus::COMPLETED);
+        } else if (i % 3 == 1) {
+            orderList[i].setPaymentStatus(OrderPaymentStatus::CANCELED);
+            paymentList[i].setStatus(PaymentStatus::FAILED);
+        }
+        stringOrders[i].seat_ids = orderList[i].getSeatIds();
+        stringOrders[i].payment_status = toString(orderList[i].getPaymentStatus());
+        stringPayments[i].status = toString(paymentList[i].getStatus());
+    }
+    
+    // Every status name fits the string's inline buffer, so the struct size is the whole cost of the status
+    cout << "Bytes per entity:" << endl;
+    cout << setw(24) << "Entity" << setw(10) << "String" << setw(10) << "Enum" << endl;
+    cout << setw(24) << "Order" << setw(10) << sizeof(StringStatusOrder) << setw(10) << sizeof(Order) << endl;
+    cout << setw(24) << "CashPayment" << setw(10) << sizeof(StringStatusCashPayment) 
+         << setw(10) << sizeof(CashPayment) << endl;
+    
+    cout << count << " entities, " << repeats << " scans each:" << endl;
+    cout << setw(24) << "Scan" << setw(10) << "Matches" << setw(14) << "String (ms)" 
+         << setw(12) << "Enum (ms)" << endl;
+    for (int scan = 0; scan < 2; scan++) {
+        long matches[2] = {0, 0};
+        double elapsedMs[2];
+        for (int encoded = 0; encoded < 2; encoded++) {
+            auto start = chrono::steady_clock::now();
+            for (int r = 0; r < repeats; r++) {
+                for (int i = 0; i < count; i++) {
+                    if (scan == 0) {
+                        matches[encoded] += encoded ? orderList[i].getPaymentStatus() == OrderPaymentStatus::PAID 
+                                                    : stringOrders[i].payment_status == "paid";
+                    } else {
+                        matches[encoded] += encoded ? paymentList[i].getStatus() == PaymentStatus::COMPLETED 
+                                                    : stringPayments[i].status == "completed";
+                    }
+                }
+            }
+            elapsedMs[encoded] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / repeats;
+        }
+        if (matches[0] != matches[1]) {
+            cout << "Error: The string and enum scans disagree!" << endl;
+        }
+        cout << setw(24) << (scan == 0 ? "Orders paid" : "Payments completed") << setw(10) << matches[1] / repeats
+             << setw(14) << fixed << setprecision(3) << elapsedMs[0] << setw(12) << elapsedMs[1] << endl;
+    }
+}
+
+// One recorded box-office action, replayed at its timestamp
+struct ReplayEvent {
+    time_t at;
+    bool hold; // false = release
+    int customer;
+    int showtime_id;
+    vector<string> seat_ids;
+};
+
+// Replays a day of box-office traffic on a simulated clock, so holds expire without waiting for them
+void BookingService::trafficReplayDemo() {
+    cout << "\n=== BOX OFFICE TRAFFIC REPLAY ===" << endl;
+    
+    const int showtimeCount = 6;
+    const int seatsPerShowtime = 200;
+    const int customerCount = 50000;
+    const int holdTimeoutSeconds = 300;
+    
+    time_t dayStart;
+    TimeService::parseDate("2025-03-14", dayStart);
+    SimulatedClock clock(dayStart);
+    BookingService service(clock);
+    Auditorium auditorium(1, "Replay Hall", seatsPerShowtime);
+    service.registerAuditorium(auditorium);
+    for (int i = 0; i < showtimeCount; i++) {
+        Showtime showtime(1, auditorium.getId(), 0, 0);
+        showtime.setId(1 + i);
+        showtime.setSeatsTotal(seatsPerShowtime);
+        service.registerShowtime(showtime);
+        service.setHoldTimeout(showtime.getId(), holdTimeoutSeconds);
+    }
+    vector<Seat> seats = service.getSeatsForShowtime(1); // Every showtime has the same layout
+    
+    // The recording: customers arrive over the day and hold 1-4 seats; most release them
+    // after a few minutes, the rest walk away and leave the hold to expire
+    vector<ReplayEvent> events;
+    minstd_rand random(2025);
+    for (int customer = 0; customer < customerCount; customer++) {
+        ReplayEvent event;
+        event.at = dayStart + random() % (24 * 3600);
+        event.hold = true;
+        event.customer = customer;
+        event.showtime_id = 1 + random() % showtimeCount;
+        int count = 1 + random() % 4;
+        int first = random() % (seats.size() - count);
+        for (int i = 0; i < count; i++) {
+            event.seat_ids.push_back(seats[first + i].getSeatId());
+        }
+        events.push_back(event);
+        
+        if (random() % 10 < 6) {
+            event.at += 30 + random() % (holdTimeoutSeconds - 60);
+            event.hold = false;
+            events.push_back(event);
+        }
+    }
+    stable_sort(events.begin(), events.end(), [](const ReplayEvent& a, const ReplayEvent& b) {
+        return a.at < b.at;
+    });
+    
+    vector<bool> holding(customerCount, false);
+    int holds = 0, rejected = 0, releases = 0;
+    auto start = chrono::steady_clock::now();
+    for (const ReplayEvent& event : events) {
+        clock.setTime(event.at);
+        if (event.hold) {
+            holding[event.customer] = service.tryHoldSeats(event.showtime_id, event.seat_ids);
+            if (holding[event.customer]) {
+                holds++;
+            } else {
+                rejected++;
+            }
+        } else if (holding[event.customer]) {
+            // Batch commands release without console output
+            vector<SeatCommand> commands(1, SeatCommand("release", event.showtime_id, event.seat_ids));
+            service.executeSeatCommands(commands);
+            holding[event.customer] = false;
+            releases++;
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    // Walk-aways are still held until the clock passes their expiry
+    int heldAtClose = 0;
+    int heldAfterTimeout = 0;
+    service.releaseExpiredHolds();
+    for (int i = 1; i <= showtimeCount; i++) {
+        heldAtClose += seatsPerShowtime - service.getAvailableSeatCount(i);
+    }
+    clock.advance(holdTimeoutSeconds);
+    service.releaseExpiredHolds();
+    for (int i = 1; i <= showtimeCount; i++) {
+        heldAfterTimeout += seatsPerShowtime - service.getAvailableSeatCount(i);
+    }
+    
+    cout << "Replayed " << events.size() << " events of " << TimeService::formatDate(dayStart) 
+         << " (24 h) in " << fixed << setprecision(3) << seconds << " s, " << setprecision(0) 
+         << 24 * 3600 / seconds << "x real time" << endl;
+    cout << "Holds: " << holds << " | Rejected: " << rejected << " | Released: " << releases 
+         << " | Expired: " << holds - releases << endl;
+    cout << "Seats held at the last event: " << heldAtClose << " | after " << holdTimeoutSeconds 
+         << " more seconds: " << heldAfterTimeout << endl;
+    
+    if (heldAfterTimeout == 0) {
+        cout << "Every abandoned hold expired on the simulated clock." << endl;
+    } else {
+        cout << "Error: Some holds outlived their timeout!" << endl;
+    }
+}
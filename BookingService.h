@@ -6,9 +6,37 @@
 #include <ctime>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <deque>
+#include <set>
+#include <functional>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "ShowtimeService.h"
+#include "BookingLog.h"
 
 using namespace std;
 
+// Seat status, as shown in seat views (SeatStateMap keeps the live state in bit planes)
+// available -> held or sold, held -> available or sold, sold -> available
+enum class SeatStatus : uint8_t { AVAILABLE, HELD, SOLD };
+
+// Order payment status: pending -> paid or canceled, paid -> refunded
+enum class OrderPaymentStatus : uint8_t { PENDING, PAID, CANCELED, REFUNDED };
+
+// Ticket status: valid -> used or canceled
+enum class TicketStatus : uint8_t { VALID, USED, CANCELED };
+
+const char* toString(SeatStatus status);
+const char* toString(OrderPaymentStatus status);
+const char* toString(TicketStatus status);
+bool parseStatus(const string& text, OrderPaymentStatus& status); // Case-insensitive
+bool canTransition(SeatStatus from, SeatStatus to);
+bool canTransition(OrderPaymentStatus from, OrderPaymentStatus to);
+bool canTransition(TicketStatus from, TicketStatus to);
+
 // Seat class
 class Seat {
 private:
@@ -16,7 +44,7 @@ private:
     string row;
     int number;
     string type; // Standard, VIP, Couple, etc.
-    string status; // available, held, sold
+    SeatStatus status;
     time_t hold_expires_at;
     int order_id;
     double price_multiplier;
@@ -30,7 +58,7 @@ public:
     string getRow() const { return row; }
     int getNumber() const { return number; }
     string getType() const { return type; }
-    string getStatus() const { return status; }
+    SeatStatus getStatus() const { return status; }
     time_t getHoldExpiresAt() const { return hold_expires_at; }
     int getOrderId() const { return order_id; }
     double getPriceMultiplier() const { return price_multiplier; }
@@ -38,18 +66,162 @@ public:
     // Setters
     void setSeatId(const string& newSeatId);
     void setType(const string& newType) { type = newType; }
-    void setStatus(const string& newStatus) { status = newStatus; }
+    bool setStatus(SeatStatus newStatus); // False if the transition is not allowed
     void setHoldExpiresAt(time_t newExpiry) { hold_expires_at = newExpiry; }
     void setOrderId(int newOrderId) { order_id = newOrderId; }
     void setPriceMultiplier(double newMultiplier) { price_multiplier = newMultiplier; }
     
     bool isAvailable() const;
     bool isHeld() const;
+    bool isHeld(time_t now) const; // For loops over many seats: read the clock once
     bool isSold() const;
     bool isHoldExpired() const;
+    bool isHoldExpired(time_t now) const;
     void displayInfo() const;
 };
 
+// SeatLayout class - immutable, compact seat map (ordinals, rows, columns, adjacency, type codes)
+// A row holds at most 64 seats so that it fits one occupancy word.
+class SeatLayout {
+private:
+    vector<string> seat_ids;
+    vector<uint8_t> type_codes; // index into type_names
+    vector<uint8_t> columns; // physical column, aisles and gaps leave columns unused
+    vector<int> row_starts; // ordinal of the first seat of each row
+    vector<string> row_labels;
+    vector<uint64_t> row_adjacency; // bit i: seats i and i+1 of the row sit side by side
+    vector<string> type_names;
+    vector<double> type_price_multipliers; // type code -> price multiplier
+    vector<vector<uint64_t>> row_type_masks; // type code -> per-row bit mask of seats of that type
+    unordered_map<string, int> ordinals; // seat_id -> ordinal
+    int next_column;
+
+public:
+    SeatLayout() : next_column(0) {}
+    
+    void addRow(const string& label, int offset = 0);
+    int addSeat(const string& seatId, const string& seatType, int column = -1); // -1 = next column
+    int findOrdinal(const string& seatId) const;
+    static double defaultPriceMultiplier(const string& seatType);
+    
+    // Getters
+    int getSeatCount() const { return (int)seat_ids.size(); }
+    int getRowCount() const { return (int)row_starts.size(); }
+    int getRowStart(int rowIndex) const { return row_starts[rowIndex]; }
+    int getRowEnd(int rowIndex) const;
+    const string& getRowLabel(int rowIndex) const { return row_labels[rowIndex]; }
+    uint64_t getRowAdjacency(int rowIndex) const { return row_adjacency[rowIndex]; }
+    const string& getSeatId(int ordinal) const { return seat_ids[ordinal]; }
+    const string& getType(int ordinal) const { return type_names[type_codes[ordinal]]; }
+    double getPriceMultiplier(int ordinal) const { return type_price_multipliers[type_codes[ordinal]]; }
+    int getColumn(int ordinal) const { return columns[ordinal]; }
+    uint64_t getRowTypeMask(int rowIndex, const string& seatType) const;
+};
+
+// SeatMapCompiler class - compiles Auditorium::seat_map_json into a SeatLayout
+// Format: {"rows": [{"label": "A", "offset": 2, "seats": "SSS_VVVV_SSS"}, ...]}
+// Seat codes: S Standard, V VIP, C Couple, P Premium, W Wheelchair; '_' or ' ' is an aisle/gap.
+// "offset" (optional) indents a row, e.g. for curved rows. Seats are numbered 01, 02, ... per row.
+class SeatMapCompiler {
+public:
+    static shared_ptr<const SeatLayout> compile(const string& seatMapJson, string& error);
+};
+
+// SeatStateMap class - seat states of one showtime kept as packed bit planes
+// Bit i of each plane belongs to the seat with ordinal i in the shared layout.
+// The planes are only allocated on the first hold or sale; until then every seat is available.
+class SeatStateMap {
+private:
+    shared_ptr<const SeatLayout> layout;
+    vector<uint64_t> available_bits;
+    vector<uint64_t> held_bits;
+    vector<uint64_t> sold_bits;
+    vector<time_t> hold_expires_at;
+    vector<int> order_ids;
+    int hold_timeout_seconds;
+
+    static int countBits(const vector<uint64_t>& plane);
+    void allocateState();
+
+public:
+    SeatStateMap();
+    explicit SeatStateMap(const shared_ptr<const SeatLayout>& seatLayout, int holdTimeoutSeconds = 300);
+    
+    // Getters
+    const SeatLayout& getLayout() const { return *layout; }
+    const shared_ptr<const SeatLayout>& getSharedLayout() const { return layout; }
+    int getSeatCount() const { return layout->getSeatCount(); }
+    int getWordCount() const { return (layout->getSeatCount() + 63) / 64; }
+    bool hasState() const { return !available_bits.empty(); }
+    int countAvailable() const { return hasState() ? countBits(available_bits) : getSeatCount(); }
+    int countHeld() const { return countBits(held_bits); }
+    int countSold() const { return countBits(sold_bits); }
+    uint64_t getRowAvailableMask(int rowIndex) const; // Bit i = seat i of the row
+    bool isAvailable(int ordinal) const { return !hasState() || ((available_bits[ordinal >> 6] >> (ordinal & 63)) & 1); }
+    bool isHeld(int ordinal) const { return hasState() && ((held_bits[ordinal >> 6] >> (ordinal & 63)) & 1); }
+    bool isSold(int ordinal) const { return hasState() && ((sold_bits[ordinal >> 6] >> (ordinal & 63)) & 1); }
+    time_t getHoldExpiresAt(int ordinal) const { return hasState() ? hold_expires_at[ordinal] : 0; }
+    int getOrderId(int ordinal) const { return hasState() ? order_ids[ordinal] : 0; }
+    int getHoldTimeout() const { return hold_timeout_seconds; }
+    
+    // Setters
+    void setHoldTimeout(int newTimeout) { hold_timeout_seconds = newTimeout; }
+    
+    // Mask operations (mask has one bit per requested seat ordinal)
+    bool buildMask(const vector<string>& seatIds, vector<uint64_t>& mask, string& unknownSeatId) const;
+    int firstUnavailable(const vector<uint64_t>& mask) const; // -1 if every masked seat is available
+    void hold(const vector<uint64_t>& mask, time_t expiresAt, int orderId = 0);
+    int releaseHeld(const vector<uint64_t>& mask, int orderId); // Only seats held for orderId (0 = no order)
+    void releaseHeld(int ordinal);
+    bool sell(const vector<uint64_t>& mask, int orderId); // Only seats that are free or held by the order
+    int releaseSold(const vector<uint64_t>& mask, int orderId); // Frees the order's sold seats, returns how many
+    
+    // Best available seats (ordinals), seatType "" accepts any type
+    vector<int> findBestSeats(int count, const string& seatType = "") const;
+    
+    // Materialize Seat objects for display and callers of the old API
+    Seat getSeat(int ordinal) const;
+    vector<Seat> getSeats() const;
+};
+
+// HoldTimerWheel class - hierarchical timing wheel of seat hold expiries
+// Level 0 has one-second slots; every slot of level N spans a full turn of level N-1,
+// so advancing the wheel only touches the slots that come due.
+class HoldTimerWheel {
+public:
+    struct Entry {
+        int showtime_id;
+        int ordinal;
+        time_t expires_at;
+    };
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    
+    vector<Entry> slots[LEVELS][SLOTS];
+    vector<Entry> overdue; // Scheduled at or before current_time
+    time_t current_time;
+    size_t pending_count;
+    
+    void place(const Entry& entry);
+
+public:
+    explicit HoldTimerWheel(time_t startTime);
+    
+    void schedule(int showtimeId, int ordinal, time_t expiresAt);
+    void advance(time_t now, vector<Entry>& expired);
+    size_t getPendingCount() const { return pending_count; }
+};
+
+// SeatShard struct - one showtime's seat states, hold timers and the lock guarding both
+struct SeatShard {
+    mutex lock;
+    SeatStateMap seats;
+    unique_ptr<HoldTimerWheel> timers; // Created on the first hold
+};
+
 // Order class
 class Order {
 private:
@@ -61,7 +233,7 @@ private:
     double tax;
     double discount;
     double total_amount;
-    string payment_status; // pending, paid, refunded
+    OrderPaymentStatus payment_status;
     string customer_name;
     string customer_phone;
     time_t created_at;
@@ -80,7 +252,7 @@ public:
     double getTax() const { return tax; }
     double getDiscount() const { return discount; }
     double getTotalAmount() const { return total_amount; }
-    string getPaymentStatus() const { return payment_status; }
+    OrderPaymentStatus getPaymentStatus() const { return payment_status; }
     string getCustomerName() const { return customer_name; }
     string getCustomerPhone() const { return customer_phone; }
     time_t getCreatedAt() const { return created_at; }
@@ -95,7 +267,8 @@ public:
     void setTax(double newTax) { tax = newTax; }
     void setDiscount(double newDiscount) { discount = newDiscount; }
     void setTotalAmount(double newTotal) { total_amount = newTotal; }
-    void setPaymentStatus(const string& newStatus) { payment_status = newStatus; updated_at = time(0); }
+    bool setPaymentStatus(OrderPaymentStatus newStatus); // False if the transition is not allowed
+    void loadPaymentStatus(OrderPaymentStatus newStatus) { payment_status = newStatus; } // Persistence and undo only, unchecked
     void setCustomerName(const string& newName) { customer_name = newName; }
     void setCustomerPhone(const string& newPhone) { customer_phone = newPhone; }
     
@@ -115,7 +288,7 @@ private:
     string auditorium_name;
     time_t show_time;
     double price;
-    string status; // valid, used, canceled
+    TicketStatus status;
     time_t issued_at;
 
 public:
@@ -131,7 +304,7 @@ public:
     string getAuditoriumName() const { return auditorium_name; }
     time_t getShowTime() const { return show_time; }
     double getPrice() const { return price; }
-    string getStatus() const { return status; }
+    TicketStatus getStatus() const { return status; }
     time_t getIssuedAt() const { return issued_at; }
     
     // Setters
@@ -143,43 +316,175 @@ public:
     void setAuditoriumName(const string& newName) { auditorium_name = newName; }
     void setShowTime(time_t newShowTime) { show_time = newShowTime; }
     void setPrice(double newPrice) { price = newPrice; }
-    void setStatus(const string& newStatus) { status = newStatus; }
+    bool setStatus(TicketStatus newStatus); // False if the transition is not allowed
+    void loadStatus(TicketStatus newStatus) { status = newStatus; } // Undo only, unchecked
     
     void displayTicket() const;
-    string generateTicketId() const;
+    static string generateTicketId(int serial);
     bool isValid() const;
 };
 
+// SeatCommand struct - one step of a kiosk or group booking batch
+struct SeatCommand {
+    string action; // hold, release, confirm
+    int showtime_id; // hold, release
+    vector<string> seat_ids; // hold, release
+    int order_id; // confirm: the order whose seats are sold and tickets issued
+    int hold_seconds; // hold: 0 = showtime's hold timeout
+    
+    SeatCommand() : showtime_id(0), order_id(0), hold_seconds(0) {}
+    SeatCommand(const string& commandAction, int showtimeId, const vector<string>& seatIds)
+        : action(commandAction), showtime_id(showtimeId), seat_ids(seatIds), order_id(0), hold_seconds(0) {}
+};
+
+// SeatClaim struct - a seat held or sold for an order before a change, so the change can be undone
+struct SeatClaim {
+    int ordinal;
+    bool sold;
+    time_t hold_expires_at; // Holds only
+};
+
+struct SeatCommandResult {
+    bool success;
+    string error;
+    time_t hold_expires_at; // Successful holds only
+    
+    SeatCommandResult() : success(false), hold_expires_at(0) {}
+};
+
 // BookingService class - Business Logic Layer
 class BookingService {
 private:
-    vector<Order> orders;
-    vector<Ticket> tickets;
-    map<int, vector<Seat>> showtimeSeats; // showtime_id -> seats
-    int nextOrderId;
-    int nextTicketId;
+    deque<Order> orders; // Slots never move, so indexes and views can point into it
+    unordered_map<int, size_t> orderIndex; // order_id -> slot
+    unordered_map<int, vector<size_t>> ordersByStaff; // staff_id -> slots in creation order
+    unordered_map<int, vector<size_t>> ordersByShowtime; // showtime_id -> slots in creation order
+    unordered_map<string, vector<size_t>> ordersByPhone; // customer_phone -> slots in creation order
+    deque<Ticket> tickets; // Slots never move, like orders
+    unordered_map<string, size_t> ticketIndex; // ticket_id -> slot
+    unordered_map<int, vector<size_t>> ticketsByOrder; // order_id -> slots
+    map<int, unique_ptr<SeatShard>> showtimeSeats; // showtime_id -> seat shard
+    map<int, shared_ptr<const SeatLayout>> auditoriumLayouts; // auditorium_id -> compiled layout
+    map<int, shared_ptr<const SeatLayout>> defaultLayouts; // seat count -> generated layout
+    atomic<int> nextOrderId;
+    
+    // Ticket serials are handed out in blocks; each thread (terminal) draws ids from its own block
+    static const int TICKET_ID_BLOCK_SIZE = 64;
+    atomic<int> nextTicketBlock;
+    unsigned long long instanceId; // Tells thread-local blocks of different services apart
+    const Clock& timeSource; // Hold expiries and timers; checks and replays pass a SimulatedClock
+    
+    // Hold deadlines, earliest first, so releaseExpiredHolds only visits showtimes with holds due. Holds with
+    // the same showtime and expiry share an entry, and each hold drains the deadlines passed into dueShowtimes,
+    // so neither grows past the holds still pending even when nobody calls releaseExpiredHolds.
+    set<pair<time_t, int>> holdDeadlines; // (expires_at, showtime_id)
+    set<int> dueShowtimes;
+    
+    // Lock order: ordersMutex, then a SeatShard lock, then holdDeadlinesMutex;
+    // seatMapsMutex and ticketsMutex are never held across calls
+    mutable mutex seatMapsMutex; // Guards the showtimeSeats and layout maps, not the shards
+    mutable recursive_mutex ordersMutex;
+    mutable mutex ticketsMutex;
+    mutex holdDeadlinesMutex;
     
+    BookingLog bookingLog; // Closed unless openLog was called
+    
+    function<void(int, int)> soldSeatsListener; // (showtime_id, sold seat delta)
+    mutex soldSeatsListenerMutex; // One notification at a time, never held with a shard lock
+    
+    string allocateTicketId();
+    void indexOrder(size_t slot);
+    void unindexOrder(size_t slot);
+    vector<const Order*> collectOrders(const vector<size_t>* slots) const;
+    SeatShard* findShard(int showtimeId) const;
+    vector<SeatShard*> getAllShards() const;
     bool validateSeatSelection(int showtimeId, const vector<string>& seatIds) const;
-    double calculateSeatPrice(const string& seatId, double basePrice) const;
-    void initializeSeatsForShowtime(int showtimeId, int totalSeats);
+    bool buildSeatMask(const SeatStateMap& seats, const vector<string>& seatIds, 
+                       vector<uint64_t>& mask, string& error) const;
+    bool acquireSeats(int showtimeId, const vector<string>& seatIds, int& holdTimeSeconds, 
+                      int orderId, time_t& holdExpiry, string& error, 
+                      const function<void(time_t)>& logHold = nullptr);
+    void undoHold(int showtimeId, const vector<string>& seatIds, int orderId, time_t holdExpiry);
+    static void collectClaims(const SeatStateMap& seats, const vector<uint64_t>& mask, int orderId, 
+                              vector<SeatClaim>& claims);
+    int restoreClaims(SeatShard& shard, int showtimeId, const vector<SeatClaim>& claims, int orderId);
+    void holdSeatsUntil(SeatShard& shard, int showtimeId, const vector<uint64_t>& mask, 
+                        time_t holdExpiry, int orderId);
+    bool holdAndLogSeats(int showtimeId, const vector<string>& seatIds, int& holdTimeSeconds, string& error);
+    void releaseSeats(int showtimeId, const vector<string>& seatIds);
+    int releaseOrderSeats(int showtimeId, const vector<string>& seatIds, int orderId, 
+                          vector<SeatClaim>* released = nullptr, const function<void()>& logRelease = nullptr);
+    void undoOrderRelease(Order& order, const vector<SeatClaim>& released, OrderPaymentStatus previousStatus);
+    int sellOrderSeats(int showtimeId, const vector<string>& seatIds, int orderId);
+    void publishSoldSeats(int showtimeId, int soldDelta);
+    void restoreHold(int showtimeId, const vector<string>& seatIds, time_t holdExpiry, int orderId);
+    uint64_t issueTicketsFor(const Order& order);
+    void addTickets(const Order& order, const vector<string>& ticketIds);
+    vector<size_t> cancelTicketsOfOrder(int orderId); // Returns the slots of the tickets it canceled
+    void restoreTickets(const vector<size_t>& slots);
+    uint64_t logRecord(const BookingLogRecord& record);
+    bool syncLog(uint64_t lsn);
+    static void writeOrder(BookingLogRecord& record, const Order& order);
+    static Order readOrder(BookingLogReader& reader);
+    bool replayRecord(const string& payload);
+    static bool compareReplay(BookingService& service, BookingService& recovered, 
+                              const int* showtimeIds, size_t showtimeCount);
+    void executeShowtimeCommands(int showtimeId, const vector<SeatCommand>& commands, 
+                                 const vector<size_t>& group, vector<SeatCommandResult>& results,
+                                 vector<Order*>& confirmOrders, vector<vector<SeatClaim>>& claims, 
+                                 uint64_t& lsn, int& soldDelta);
+    void undoSeatCommands(const vector<SeatCommand>& commands, vector<SeatCommandResult>& results, 
+                          const vector<Order*>& confirmOrders, const vector<vector<SeatClaim>>& claims);
+    void expireHolds(SeatShard& shard, time_t now);
+    void drainHoldDeadlines(time_t now);
+    double calculateSeatPrice(const SeatLayout* layout, const string& seatId, double basePrice) const;
+    shared_ptr<const SeatLayout> getDefaultLayout(int totalSeats);
+    void initializeSeatsForShowtime(int showtimeId, const shared_ptr<const SeatLayout>& layout, 
+                                    int holdTimeoutSeconds = 300);
     vector<Seat> heapSortSeats(vector<Seat> seatList, bool byPrice = false) const;
 
 public:
-    BookingService();
+    explicit BookingService(const Clock& clock = TimeService::systemClock());
+    
+    // Write-ahead log: replays the log at path, then appends every booking mutation to it
+    bool openLog(const string& path, bool groupCommit = true);
+    void closeLog();
+    
+    // Sold seat changes are published as deltas (e.g. to keep ShowtimeService occupancy current)
+    void setSoldSeatsListener(const function<void(int, int)>& listener) { soldSeatsListener = listener; }
     
     // Seat management
+    bool registerAuditorium(const Auditorium& auditorium);
+    bool registerShowtime(const Showtime& showtime);
+    bool setHoldTimeout(int showtimeId, int holdTimeoutSeconds);
     vector<Seat> getSeatsForShowtime(int showtimeId);
-    bool holdSeats(int showtimeId, const vector<string>& seatIds, int holdTimeMinutes = 5);
+    bool holdSeats(int showtimeId, const vector<string>& seatIds, int holdTimeMinutes = 0); // 0 = showtime's hold timeout
+    bool tryHoldSeats(int showtimeId, const vector<string>& seatIds, int holdTimeSeconds = 0); // No console output
     bool releaseHeldSeats(int showtimeId, const vector<string>& seatIds);
     void releaseExpiredHolds();
     bool areSeatsAvailable(int showtimeId, const vector<string>& seatIds) const;
+    int getAvailableSeatCount(int showtimeId) const;
+    vector<string> findBestSeats(int showtimeId, int count, const string& seatType = "") const;
+    
+    // Batch commands: grouped by showtime, one lock and lookup per group, results in command order, no console output
+    vector<SeatCommandResult> executeSeatCommands(const vector<SeatCommand>& commands);
     
     // Order management
+    // Staff, showtime and phone are indexed; change them through updateOrder or exchangeTicket only
     bool createOrder(const Order& order);
     bool updateOrder(int orderId, const Order& updatedOrder);
     Order* findOrderById(int orderId);
+    const Order* findOrderById(int orderId) const;
     vector<Order> getOrdersByStaff(int staffId) const;
     vector<Order> getOrdersByShowtime(int showtimeId) const;
+    // Exact phone or part of the name, newest first; stops early once *canceled is set
+    vector<Order> getOrdersByCustomer(const string& query, size_t limit, const atomic<bool>* canceled = nullptr) const;
+    
+    // Order views: pointers stay valid for the service's lifetime, no seat lists are copied
+    vector<const Order*> findOrdersByStaff(int staffId) const;
+    vector<const Order*> findOrdersByShowtime(int showtimeId) const;
+    vector<const Order*> findOrdersByPhone(const string& customerPhone) const;
+    int getOrderCount() const;
     
     // Booking process
     bool confirmBooking(int orderId);
@@ -191,6 +496,7 @@ public:
     bool issueTickets(int orderId);
     vector<Ticket> getTicketsByOrder(int orderId) const;
     Ticket* findTicketById(const string& ticketId);
+    bool getTicketById(const string& ticketId, Ticket& ticket) const; // Copied under the ticket lock
     bool validateTicket(const string& ticketId) const;
     
     // Pricing
@@ -209,6 +515,16 @@ public:
     void printTicketDemo();
     void exchangeTicketDemo();
     void refundTicketDemo();
+    void concurrentBookingDemo();
+    void seatMapBenchmarkDemo();
+    void bookingLogBenchmarkDemo();
+    void statusEncodingBenchmarkDemo();
+    void trafficReplayDemo();
+    
+    // Self-checks: false (with the reason on the console) when an invariant is broken
+    static bool concurrentHoldCheck();
+    static bool concurrentSalesCheck();
+    static bool logReplayCheck();
     
     // Utility
     void displayAllOrders() const;
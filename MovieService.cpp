@@ -2,28 +2,65 @@
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <chrono>
+#include <random>
+#include <bitset>
+#include <iterator>
+#include <set>
 
-// Movie class implementation
-Movie::Movie() : Entity(), duration_min(0), release_date(0) {
-    status = "active";
+// Movie status
+const char* toString(MovieStatus status) {
+    switch (status) {
+        case MovieStatus::ACTIVE: return "active";
+        case MovieStatus::INACTIVE: return "inactive";
+        case MovieStatus::ARCHIVED: return "archived";
+    }
+    return "unknown";
+}
+
+bool parseStatus(const string& text, MovieStatus& status) {
+    string name = text;
+    transform(name.begin(), name.end(), name.begin(), ::tolower);
+    for (MovieStatus candidate : {MovieStatus::ACTIVE, MovieStatus::INACTIVE, MovieStatus::ARCHIVED}) {
+        if (name == toString(candidate)) {
+            status = candidate;
+            return true;
+        }
+    }
+    return false;
 }
 
+bool canTransition(MovieStatus from, MovieStatus to) {
+    return from == to || from != MovieStatus::ARCHIVED;
+}
+
+// Movie class implementation
+Movie::Movie() : Entity(), duration_min(0), status(MovieStatus::ACTIVE), release_date(0) {}
+
 Movie::Movie(const string& title, int duration, const string& rating) 
-    : Entity(), title(title), duration_min(duration), rating_age(rating) {
-    status = "active";
-    release_date = time(0);
+    : Entity(), title(title), duration_min(duration), rating_age(rating), status(MovieStatus::ACTIVE) {
+    release_date = TimeService::now();
     slug = title; // Simplified slug generation
     transform(slug.begin(), slug.end(), slug.begin(), ::tolower);
     replace(slug.begin(), slug.end(), ' ', '-');
 }
 
+bool Movie::setStatus(MovieStatus newStatus) {
+    if (!canTransition(status, newStatus)) {
+        return false;
+    }
+    status = newStatus;
+    updateTimestamp();
+    return true;
+}
+
 bool Movie::isValid() const {
     return !title.empty() && duration_min > 0 && !rating_age.empty();
 }
 
 void Movie::displayInfo() const {
     cout << "ID: " << id << " | Title: " << title << " | Duration: " << duration_min 
-         << " min | Rating: " << rating_age << " | Status: " << status << endl;
+         << " min | Rating: " << rating_age << " | Status: " << toString(status) << endl;
 }
 
 // MovieVersion class implementation
@@ -32,26 +69,590 @@ MovieVersion::MovieVersion() : Entity(), movie_id(0), runtime(0) {}
 MovieVersion::MovieVersion(int movieId, const string& versionType, int versionRuntime)
     : Entity(), movie_id(movieId), type(versionType), runtime(versionRuntime) {}
 
+// TrigramIndex class implementation
+vector<uint32_t> TrigramIndex::getTrigrams(const string& text) {
+    vector<uint32_t> trigrams;
+    for (size_t i = 0; i + 3 <= text.size(); i++) {
+        trigrams.push_back(((uint32_t)(unsigned char)text[i] << 16) | 
+                           ((uint32_t)(unsigned char)text[i + 1] << 8) | 
+                           (uint32_t)(unsigned char)text[i + 2]);
+    }
+    sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+void TrigramIndex::add(size_t slot, const vector<uint32_t>& trigrams) {
+    for (uint32_t trigram : trigrams) {
+        vector<size_t>& slots = postings[trigram];
+        if (slots.empty() || slots.back() < slot) {
+            slots.push_back(slot); // New movies take the highest slot, so this is the usual case
+        } else {
+            auto it = lower_bound(slots.begin(), slots.end(), slot);
+            if (*it != slot) {
+                slots.insert(it, slot);
+            }
+        }
+    }
+}
+
+void TrigramIndex::remove(size_t slot, const vector<uint32_t>& trigrams) {
+    for (uint32_t trigram : trigrams) {
+        auto found = postings.find(trigram);
+        if (found == postings.end()) {
+            continue;
+        }
+        vector<size_t>& slots = found->second;
+        auto it = lower_bound(slots.begin(), slots.end(), slot);
+        if (it != slots.end() && *it == slot) {
+            slots.erase(it);
+        }
+        if (slots.empty()) {
+            postings.erase(found);
+        }
+    }
+}
+
+vector<size_t> TrigramIndex::intersect(const vector<uint32_t>& trigrams) const {
+    vector<const vector<size_t>*> lists;
+    for (uint32_t trigram : trigrams) {
+        auto found = postings.find(trigram);
+        if (found == postings.end()) {
+            return vector<size_t>(); // Some trigram occurs nowhere
+        }
+        lists.push_back(&found->second);
+    }
+    if (lists.empty()) {
+        return vector<size_t>();
+    }
+    sort(lists.begin(), lists.end(), [](const vector<size_t>* a, const vector<size_t>* b) {
+        return a->size() < b->size();
+    });
+    
+    // Keep the shortest list's slots that every longer list also has
+    vector<size_t> result = *lists[0];
+    for (size_t i = 1; i < lists.size() && !result.empty(); i++) {
+        const vector<size_t>& slots = *lists[i];
+        auto position = slots.begin();
+        size_t kept = 0;
+        for (size_t slot : result) {
+            position = lower_bound(position, slots.end(), slot);
+            if (position == slots.end()) {
+                break;
+            }
+            if (*position == slot) {
+                result[kept++] = slot;
+            }
+        }
+        result.resize(kept);
+    }
+    return result;
+}
+
+void TrigramIndex::countMatches(const vector<uint32_t>& trigrams, vector<uint16_t>& counts, 
+                                vector<size_t>& touched) const {
+    for (uint32_t trigram : trigrams) {
+        auto found = postings.find(trigram);
+        if (found == postings.end()) {
+            continue;
+        }
+        for (size_t slot : found->second) {
+            if (counts[slot]++ == 0) {
+                touched.push_back(slot);
+            }
+        }
+    }
+}
+
+// FuzzyPattern class implementation
+FuzzyPattern::FuzzyPattern(const string& pattern) : length((int)min(pattern.size(), (size_t)MAX_LENGTH)) {
+    fill(peq, peq + 256, 0);
+    for (int i = 0; i < length; i++) {
+        peq[(unsigned char)pattern[i]] |= (uint64_t)1 << i;
+    }
+}
+
+// Myers' algorithm with Hyyro's transposition term: one column of the edit distance matrix per text
+// character, kept as bit vectors of vertical deltas (+1/-1). Swapping two neighbouring characters
+// counts as one edit. Row 0 stays zero, so a match may start anywhere in the text.
+int FuzzyPattern::findDistance(const string& text, int maxDistance) const {
+    if (length == 0) {
+        return 0;
+    }
+    
+    uint64_t positive = ~(uint64_t)0; // Vertical +1 deltas
+    uint64_t negative = 0; // Vertical -1 deltas
+    uint64_t diagonalZero = 0; // Diagonal deltas of 0
+    uint64_t previousEqual = 0;
+    uint64_t lastRow = (uint64_t)1 << (length - 1);
+    int score = length; // Distance of the whole pattern ending at the current text position
+    int best = score;
+    
+    int remaining = (int)text.size();
+    for (char c : text) {
+        // The score drops by at most 1 per character, stop once it cannot get within maxDistance
+        if (score - remaining > maxDistance && best > maxDistance) {
+            break;
+        }
+        remaining--;
+        
+        uint64_t equal = peq[(unsigned char)c];
+        uint64_t transposed = (((~diagonalZero) & equal) << 1) & previousEqual;
+        diagonalZero = (((equal & positive) + positive) ^ positive) | equal | negative | transposed;
+        uint64_t horizontalPositive = negative | ~(diagonalZero | positive);
+        uint64_t horizontalNegative = diagonalZero & positive;
+        
+        // Without branches: the last row moves unpredictably, mispredictions would cost more than the update
+        score += (int)((horizontalPositive & lastRow) != 0) - (int)((horizontalNegative & lastRow) != 0);
+        best = min(best, score);
+        
+        horizontalPositive <<= 1;
+        negative = horizontalPositive & diagonalZero;
+        positive = (horizontalNegative << 1) | ~(horizontalPositive | diagonalZero);
+        previousEqual = equal;
+    }
+    return best <= maxDistance ? best : maxDistance + 1;
+}
+
+// RoaringBitmap class implementation
+static int bitCount(uint64_t word) {
+    return (int)bitset<64>(word).count();
+}
+
+static int lowestBitIndex(uint64_t word) {
+    return bitCount((word & (~word + 1)) - 1);
+}
+
+void RoaringBitmap::toBitset(Container& container) {
+    container.words.assign(BITSET_WORDS, 0);
+    for (uint16_t value : container.values) {
+        container.words[value >> 6] |= (uint64_t)1 << (value & 63);
+    }
+    vector<uint16_t>().swap(container.values);
+}
+
+void RoaringBitmap::toArray(Container& container) {
+    container.values.clear();
+    for (int w = 0; w < BITSET_WORDS; w++) {
+        for (uint64_t word = container.words[w]; word; word &= word - 1) {
+            container.values.push_back((uint16_t)(w * 64 + lowestBitIndex(word)));
+        }
+    }
+    vector<uint64_t>().swap(container.words);
+}
+
+void RoaringBitmap::add(uint32_t slot) {
+    uint16_t key = (uint16_t)(slot >> 16);
+    uint16_t value = (uint16_t)(slot & 0xFFFF);
+    auto it = lower_bound(containers.begin(), containers.end(), key, 
+                          [](const Container& container, uint16_t k) { return container.key < k; });
+    if (it == containers.end() || it->key != key) {
+        Container container;
+        container.key = key;
+        container.cardinality = 0;
+        it = containers.insert(it, container);
+    }
+    
+    if (it->isBitset()) {
+        uint64_t& word = it->words[value >> 6];
+        uint64_t bit = (uint64_t)1 << (value & 63);
+        if (!(word & bit)) {
+            word |= bit;
+            it->cardinality++;
+        }
+        return;
+    }
+    
+    auto position = lower_bound(it->values.begin(), it->values.end(), value);
+    if (position != it->values.end() && *position == value) {
+        return;
+    }
+    it->values.insert(position, value);
+    it->cardinality++;
+    if (it->cardinality > ARRAY_LIMIT) {
+        toBitset(*it);
+    }
+}
+
+void RoaringBitmap::remove(uint32_t slot) {
+    uint16_t key = (uint16_t)(slot >> 16);
+    uint16_t value = (uint16_t)(slot & 0xFFFF);
+    auto it = lower_bound(containers.begin(), containers.end(), key, 
+                          [](const Container& container, uint16_t k) { return container.key < k; });
+    if (it == containers.end() || it->key != key) {
+        return;
+    }
+    
+    if (it->isBitset()) {
+        uint64_t& word = it->words[value >> 6];
+        uint64_t bit = (uint64_t)1 << (value & 63);
+        if (!(word & bit)) {
+            return;
+        }
+        word &= ~bit;
+        it->cardinality--;
+        if (it->cardinality <= ARRAY_SHRINK_LIMIT) {
+            toArray(*it);
+        }
+    } else {
+        auto position = lower_bound(it->values.begin(), it->values.end(), value);
+        if (position == it->values.end() || *position != value) {
+            return;
+        }
+        it->values.erase(position);
+        it->cardinality--;
+    }
+    
+    if (it->cardinality == 0) {
+        containers.erase(it);
+    }
+}
+
+bool RoaringBitmap::contains(uint32_t slot) const {
+    uint16_t key = (uint16_t)(slot >> 16);
+    uint16_t value = (uint16_t)(slot & 0xFFFF);
+    auto it = lower_bound(containers.begin(), containers.end(), key, 
+                          [](const Container& container, uint16_t k) { return container.key < k; });
+    if (it == containers.end() || it->key != key) {
+        return false;
+    }
+    if (it->isBitset()) {
+        return (it->words[value >> 6] >> (value & 63)) & 1;
+    }
+    return binary_search(it->values.begin(), it->values.end(), value);
+}
+
+size_t RoaringBitmap::getCardinality() const {
+    size_t cardinality = 0;
+    for (const Container& container : containers) {
+        cardinality += container.cardinality;
+    }
+    return cardinality;
+}
+
+RoaringBitmap::Container RoaringBitmap::intersectContainers(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    result.cardinality = 0;
+    
+    if (a.isBitset() && b.isBitset()) {
+        result.words.resize(BITSET_WORDS);
+        for (int w = 0; w < BITSET_WORDS; w++) {
+            result.words[w] = a.words[w] & b.words[w];
+            result.cardinality += bitCount(result.words[w]);
+        }
+        if (result.cardinality <= ARRAY_LIMIT) {
+            toArray(result);
+        }
+    } else if (a.isBitset() || b.isBitset()) {
+        const Container& array = a.isBitset() ? b : a;
+        const Container& bitset = a.isBitset() ? a : b;
+        for (uint16_t value : array.values) {
+            if ((bitset.words[value >> 6] >> (value & 63)) & 1) {
+                result.values.push_back(value);
+            }
+        }
+        result.cardinality = (int)result.values.size();
+    } else {
+        set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), 
+                         back_inserter(result.values));
+        result.cardinality = (int)result.values.size();
+    }
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::uniteContainers(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    result.cardinality = 0;
+    
+    if (!a.isBitset() && !b.isBitset() && a.cardinality + b.cardinality <= ARRAY_LIMIT) {
+        set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), 
+                  back_inserter(result.values));
+        result.cardinality = (int)result.values.size();
+        return result;
+    }
+    
+    result.words.assign(BITSET_WORDS, 0);
+    for (const Container* container : {&a, &b}) {
+        if (container->isBitset()) {
+            for (int w = 0; w < BITSET_WORDS; w++) {
+                result.words[w] |= container->words[w];
+            }
+        } else {
+            for (uint16_t value : container->values) {
+                result.words[value >> 6] |= (uint64_t)1 << (value & 63);
+            }
+        }
+    }
+    for (int w = 0; w < BITSET_WORDS; w++) {
+        result.cardinality += bitCount(result.words[w]);
+    }
+    if (result.cardinality <= ARRAY_LIMIT) {
+        toArray(result);
+    }
+    return result;
+}
+
+int RoaringBitmap::intersectCount(const Container& a, const Container& b) {
+    int count = 0;
+    if (a.isBitset() && b.isBitset()) {
+        for (int w = 0; w < BITSET_WORDS; w++) {
+            count += bitCount(a.words[w] & b.words[w]);
+        }
+    } else if (a.isBitset() || b.isBitset()) {
+        const Container& array = a.isBitset() ? b : a;
+        const Container& bitset = a.isBitset() ? a : b;
+        for (uint16_t value : array.values) {
+            count += (int)((bitset.words[value >> 6] >> (value & 63)) & 1);
+        }
+    } else {
+        auto i = a.values.begin();
+        auto j = b.values.begin();
+        while (i != a.values.end() && j != b.values.end()) {
+            if (*i < *j) {
+                i++;
+            } else if (*j < *i) {
+                j++;
+            } else {
+                count++;
+                i++;
+                j++;
+            }
+        }
+    }
+    return count;
+}
+
+RoaringBitmap RoaringBitmap::intersect(const RoaringBitmap& other) const {
+    RoaringBitmap result;
+    size_t i = 0, j = 0;
+    while (i < containers.size() && j < other.containers.size()) {
+        if (containers[i].key < other.containers[j].key) {
+            i++;
+        } else if (other.containers[j].key < containers[i].key) {
+            j++;
+        } else {
+            Container container = intersectContainers(containers[i++], other.containers[j++]);
+            if (container.cardinality > 0) {
+                result.containers.push_back(move(container));
+            }
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::unite(const RoaringBitmap& other) const {
+    RoaringBitmap result;
+    size_t i = 0, j = 0;
+    while (i < containers.size() || j < other.containers.size()) {
+        if (j == other.containers.size() || (i < containers.size() && containers[i].key < other.containers[j].key)) {
+            result.containers.push_back(containers[i++]);
+        } else if (i == containers.size() || other.containers[j].key < containers[i].key) {
+            result.containers.push_back(other.containers[j++]);
+        } else {
+            result.containers.push_back(uniteContainers(containers[i++], other.containers[j++]));
+        }
+    }
+    return result;
+}
+
+size_t RoaringBitmap::intersectCount(const RoaringBitmap& other) const {
+    size_t count = 0;
+    size_t i = 0, j = 0;
+    while (i < containers.size() && j < other.containers.size()) {
+        if (containers[i].key < other.containers[j].key) {
+            i++;
+        } else if (other.containers[j].key < containers[i].key) {
+            j++;
+        } else {
+            count += intersectCount(containers[i++], other.containers[j++]);
+        }
+    }
+    return count;
+}
+
+vector<uint32_t> RoaringBitmap::toSlots() const {
+    vector<uint32_t> slots;
+    slots.reserve(getCardinality());
+    for (const Container& container : containers) {
+        uint32_t high = (uint32_t)container.key << 16;
+        if (container.isBitset()) {
+            for (int w = 0; w < BITSET_WORDS; w++) {
+                for (uint64_t word = container.words[w]; word; word &= word - 1) {
+                    slots.push_back(high | (uint32_t)(w * 64 + lowestBitIndex(word)));
+                }
+            }
+        } else {
+            for (uint16_t value : container.values) {
+                slots.push_back(high | value);
+            }
+        }
+    }
+    return slots;
+}
+
 // MovieService class implementation
-MovieService::MovieService() : nextMovieId(1) {
+MovieService::MovieService() : nextMovieId(1), nextVersionId(1), revision(0) {
     // Initialize with some sample data
     Movie movie1("Aquaman", 143, "PG-13");
     movie1.setId(nextMovieId++);
     movie1.setGenres({"Action", "Adventure", "Fantasy"});
     movie1.setLanguage("English");
-    movies.push_back(movie1);
+    addMovie(movie1);
     
     Movie movie2("Spider-Man", 121, "PG-13");
     movie2.setId(nextMovieId++);
     movie2.setGenres({"Action", "Adventure", "Sci-Fi"});
     movie2.setLanguage("English");
-    movies.push_back(movie2);
+    addMovie(movie2);
     
     Movie movie3("The Batman", 176, "PG-13");
     movie3.setId(nextMovieId++);
     movie3.setGenres({"Action", "Crime", "Drama"});
     movie3.setLanguage("English");
-    movies.push_back(movie3);
+    addMovie(movie3);
+    
+    // Sample versions; the sample showtimes are version 1
+    for (const MovieVersion& version : {MovieVersion(1, "2D", 143), MovieVersion(1, "IMAX", 143), 
+                                        MovieVersion(2, "2D", 121), MovieVersion(3, "2D", 176)}) {
+        addMovieVersion(version);
+    }
+}
+
+void MovieService::bumpRevision(int movieId) {
+    revision++;
+    auto it = movieRevisions.find(movieId);
+    if (it != movieRevisions.end()) {
+        changedMovies.erase(it->second);
+    }
+    movieRevisions[movieId] = revision;
+    changedMovies[revision] = movieId;
+}
+
+vector<int> MovieService::getMoviesChangedSince(unsigned long sinceRevision) const {
+    vector<int> movieIds;
+    for (auto it = changedMovies.upper_bound(sinceRevision); it != changedMovies.end(); ++it) {
+        movieIds.push_back(it->second);
+    }
+    return movieIds;
+}
+
+void MovieService::addMovie(const Movie& movie) {
+    bumpRevision(movie.getId());
+    movies.push_back(movie);
+    movieIndex[movie.getId()] = movies.size() - 1;
+    searchEntries.push_back(MovieSearchEntry());
+    if (movie.getStatus() != MovieStatus::ARCHIVED) {
+        indexMovie(movies.size() - 1);
+    }
+    addToFacets(movies.size() - 1);
+}
+
+void MovieService::indexMovie(size_t slot) {
+    const Movie& movie = movies[slot];
+    MovieSearchEntry& entry = searchEntries[slot];
+    
+    for (const string& text : {movie.getTitle(), movie.getOriginalTitle(), movie.getSlug()}) {
+        string field = normalizeText(text);
+        if (field.empty() || find(entry.fields.begin(), entry.fields.end(), field) != entry.fields.end()) {
+            continue;
+        }
+        vector<uint32_t> fieldTrigrams = TrigramIndex::getTrigrams(field);
+        entry.trigrams.insert(entry.trigrams.end(), fieldTrigrams.begin(), fieldTrigrams.end());
+        entry.fields.push_back(field);
+    }
+    sort(entry.trigrams.begin(), entry.trigrams.end());
+    entry.trigrams.erase(unique(entry.trigrams.begin(), entry.trigrams.end()), entry.trigrams.end());
+    
+    titleTrigrams.add(slot, entry.trigrams);
+    entry.indexed = true;
+}
+
+void MovieService::unindexMovie(size_t slot) {
+    MovieSearchEntry& entry = searchEntries[slot];
+    if (entry.indexed) {
+        titleTrigrams.remove(slot, entry.trigrams);
+        entry = MovieSearchEntry();
+    }
+}
+
+void MovieService::addToFacets(size_t slot) {
+    const Movie& movie = movies[slot];
+    uint32_t facetSlot = (uint32_t)slot;
+    allMovies.add(facetSlot);
+    statusFacet[movie.getStatus()].add(facetSlot);
+    for (const string& genre : movie.getGenres()) {
+        genreFacet[genre].add(facetSlot);
+    }
+    ratingFacet[movie.getRating()].add(facetSlot);
+    yearFacet[getReleaseYear(movie)].add(facetSlot);
+}
+
+// Drops the slot from the values the movie has now; call before the movie changes
+void MovieService::removeFromFacets(size_t slot) {
+    const Movie& movie = movies[slot];
+    uint32_t facetSlot = (uint32_t)slot;
+    allMovies.remove(facetSlot);
+    
+    // Values without movies leave their facet, so they are not offered as options
+    auto removeFrom = [facetSlot](RoaringBitmap& bitmap) {
+        bitmap.remove(facetSlot);
+        return bitmap.isEmpty();
+    };
+    if (removeFrom(statusFacet[movie.getStatus()])) {
+        statusFacet.erase(movie.getStatus());
+    }
+    for (const string& genre : movie.getGenres()) {
+        if (removeFrom(genreFacet[genre])) {
+            genreFacet.erase(genre);
+        }
+    }
+    if (removeFrom(ratingFacet[movie.getRating()])) {
+        ratingFacet.erase(movie.getRating());
+    }
+    int year = getReleaseYear(movie);
+    if (removeFrom(yearFacet[year])) {
+        yearFacet.erase(year);
+    }
+}
+
+int MovieService::getReleaseYear(const Movie& movie) {
+    return TimeService::dayKey(movie.getReleaseDate()) / 10000;
+}
+
+// Lowercase, hyphens as spaces, so a slug matches its title
+string MovieService::normalizeText(const string& text) {
+    string normalized = text;
+    transform(normalized.begin(), normalized.end(), normalized.begin(), ::tolower);
+    replace(normalized.begin(), normalized.end(), '-', ' ');
+    return normalized;
+}
+
+// Exact match 100, contains 80, otherwise 60 less a share per typo, up to maxDistance typos
+int MovieService::scoreMatch(const MovieSearchEntry& entry, const string& query, 
+                             const FuzzyPattern& pattern, int maxDistance) {
+    int score = 0;
+    for (const string& field : entry.fields) {
+        if (field == query) {
+            return 100;
+        }
+        if (field.find(query) != string::npos) {
+            score = 80;
+        }
+    }
+    if (score > 0) {
+        return score;
+    }
+    
+    int distance = maxDistance + 1;
+    for (const string& field : entry.fields) {
+        distance = min(distance, pattern.findDistance(field, maxDistance));
+    }
+    if (distance > maxDistance) {
+        return 0;
+    }
+    return 60 * (pattern.getLength() - distance) / pattern.getLength();
 }
 
 bool MovieService::validateMovie(const Movie& movie) const {
@@ -105,7 +706,7 @@ bool MovieService::createMovie(const Movie& movie) {
     Movie newMovie = movie;
     newMovie.setId(nextMovieId++);
     newMovie.setSlug(generateSlug(movie.getTitle()));
-    movies.push_back(newMovie);
+    addMovie(newMovie);
     
     cout << "Movie created successfully with ID: " << newMovie.getId() << endl;
     return true;
@@ -122,15 +723,29 @@ bool MovieService::updateMovie(int movieId, const Movie& updatedMovie) {
         return false;
     }
     
+    if (!canTransition(movie->getStatus(), updatedMovie.getStatus())) {
+        cout << "Error: Cannot change movie status from " << toString(movie->getStatus()) 
+             << " to " << toString(updatedMovie.getStatus()) << "!" << endl;
+        return false;
+    }
+    
     // Check if trying to set inactive status while having active showtimes
-    if (updatedMovie.getStatus() == "inactive" && hasActiveShowtimes(movieId)) {
+    if (updatedMovie.getStatus() == MovieStatus::INACTIVE && hasActiveShowtimes(movieId)) {
         cout << "Error: Cannot set movie to inactive while it has active showtimes!" << endl;
         return false;
     }
     
+    size_t slot = movieIndex[movieId];
+    bumpRevision(movieId);
+    unindexMovie(slot);
+    removeFromFacets(slot);
     *movie = updatedMovie;
     movie->setId(movieId); // Preserve original ID
     movie->updateTimestamp();
+    if (movie->getStatus() != MovieStatus::ARCHIVED) {
+        indexMovie(slot);
+    }
+    addToFacets(slot);
     
     cout << "Movie updated successfully!" << endl;
     return true;
@@ -148,69 +763,116 @@ bool MovieService::archiveMovie(int movieId) {
         return false;
     }
     
-    movie->setStatus("archived");
-    movie->updateTimestamp();
+    size_t slot = movieIndex[movieId];
+    bumpRevision(movieId);
+    removeFromFacets(slot);
+    movie->setStatus(MovieStatus::ARCHIVED); // Allowed from any status
+    addToFacets(slot);
+    unindexMovie(slot); // Archived movies drop out of search
     
     cout << "Movie archived successfully!" << endl;
     return true;
 }
 
 Movie* MovieService::findMovieById(int movieId) {
-    for (auto& movie : movies) {
-        if (movie.getId() == movieId) {
-            return &movie;
-        }
-    }
-    return nullptr;
+    auto it = movieIndex.find(movieId);
+    return it == movieIndex.end() ? nullptr : &movies[it->second];
+}
+
+const Movie* MovieService::findMovieById(int movieId) const {
+    auto it = movieIndex.find(movieId);
+    return it == movieIndex.end() ? nullptr : &movies[it->second];
 }
 
 // Fuzzy search implementation - finds best matches even with typos
 vector<Movie> MovieService::searchMovies(const string& query) const {
     vector<Movie> results;
-    vector<pair<Movie, int>> scoredResults;
+    for (const Movie* movie : findMovies(query)) {
+        results.push_back(*movie);
+    }
+    return results;
+}
+
+// Titles containing the query come from the trigram index; typo matches are scored by edit distance
+vector<const Movie*> MovieService::findMovies(const string& query, size_t limit, const atomic<bool>* canceled) const {
+    vector<const Movie*> results;
+    string lowerQuery = normalizeText(query);
+    if (lowerQuery.empty() || limit == 0) {
+        return results;
+    }
     
-    for (const auto& movie : movies) {
-        int score = 0;
-        string title = movie.getTitle();
-        transform(title.begin(), title.end(), title.begin(), ::tolower);
-        string lowerQuery = query;
-        transform(lowerQuery.begin(), lowerQuery.end(), lowerQuery.begin(), ::tolower);
-        
-        // Exact match gets highest score
-        if (title == lowerQuery) {
-            score = 100;
-        }
-        // Contains query gets high score
-        else if (title.find(lowerQuery) != string::npos) {
-            score = 80;
+    FuzzyPattern pattern(lowerQuery); // Compiled once, scored against every candidate
+    // About one typo per four characters: none up to 2 characters, 1 up to 6, 2 up to 10, ...
+    int maxDistance = (pattern.getLength() + 1) / 4;
+    
+    vector<pair<size_t, int>> scoredSlots; // slot, score
+    vector<size_t> containingSlots;
+    vector<uint32_t> trigrams = TrigramIndex::getTrigrams(lowerQuery);
+    size_t containing = 0;
+    if (!trigrams.empty()) {
+        // A title containing the query has all of its trigrams
+        containingSlots = titleTrigrams.intersect(trigrams);
+        for (size_t slot : containingSlots) {
+            if (canceled && *canceled) {
+                break;
+            }
+            int score = scoreMatch(searchEntries[slot], lowerQuery, pattern, maxDistance);
+            if (score >= 80) {
+                containing++;
+            }
+            if (score > 30) { // Threshold for relevance
+                scoredSlots.push_back({slot, score});
+            }
         }
-        // Fuzzy matching - check for similar characters
-        else {
-            int matches = 0;
-            for (char c : lowerQuery) {
-                if (title.find(c) != string::npos) {
-                    matches++;
+    }
+    
+    // Typo matches score 60 at most, so they only matter when too few titles contain the query
+    if (containing < limit && !(canceled && *canceled)) {
+        // An insert, delete or replace touches at most 3 of the query's trigram windows and a swap of
+        // neighbours (one edit for FuzzyPattern) touches 4, so a match within maxDistance shares at least this many
+        int minShared = (int)trigrams.size() - 4 * maxDistance;
+        if (minShared >= 1) {
+            vector<uint16_t> counts(searchEntries.size(), 0);
+            vector<size_t> touched;
+            titleTrigrams.countMatches(trigrams, counts, touched);
+            for (size_t slot : touched) {
+                if (canceled && *canceled) {
+                    break;
+                }
+                if (counts[slot] >= minShared && counts[slot] < trigrams.size()) {
+                    int score = scoreMatch(searchEntries[slot], lowerQuery, pattern, maxDistance);
+                    if (score > 30) {
+                        scoredSlots.push_back({slot, score});
+                    }
+                }
+            }
+        } else {
+            // Short or typo-heavy query: no trigram filter is safe, score every searchable title
+            auto next = containingSlots.begin();
+            for (size_t slot = 0; slot < searchEntries.size() && !(canceled && *canceled); slot++) {
+                if (next != containingSlots.end() && *next == slot) {
+                    next++;
+                    continue; // Scored above
+                }
+                if (searchEntries[slot].indexed) {
+                    int score = scoreMatch(searchEntries[slot], lowerQuery, pattern, maxDistance);
+                    if (score > 30) {
+                        scoredSlots.push_back({slot, score});
+                    }
                 }
             }
-            score = (matches * 60) / lowerQuery.length();
-        }
-        
-        if (score > 30) { // Threshold for relevance
-            scoredResults.push_back({movie, score});
         }
     }
     
-    // Sort by score (highest first)
-    sort(scoredResults.begin(), scoredResults.end(), 
-         [](const pair<Movie, int>& a, const pair<Movie, int>& b) {
-             return a.second > b.second;
-         });
-    
-    // Return top 10 results
-    for (size_t i = 0; i < min(scoredResults.size(), size_t(10)); ++i) {
-        results.push_back(scoredResults[i].first);
+    // Highest score first, catalog order among equals
+    size_t count = min(limit, scoredSlots.size());
+    partial_sort(scoredSlots.begin(), scoredSlots.begin() + count, scoredSlots.end(), 
+                 [](const pair<size_t, int>& a, const pair<size_t, int>& b) {
+                     return a.second != b.second ? a.second > b.second : a.first < b.first;
+                 });
+    for (size_t i = 0; i < count; i++) {
+        results.push_back(&movies[scoredSlots[i].first]);
     }
-    
     return results;
 }
 
@@ -218,28 +880,151 @@ vector<Movie> MovieService::filterMovies(const string& status, const string& gen
                                         const string& rating, int year) const {
     vector<Movie> results;
     
-    for (const auto& movie : movies) {
-        bool matches = true;
-        
-        if (!status.empty() && movie.getStatus() != status) {
-            matches = false;
+    MovieFilter filter;
+    if (!status.empty()) {
+        MovieStatus statusFilter;
+        if (!parseStatus(status, statusFilter)) {
+            return results; // Unknown status
+        }
+        filter.statuses.push_back(statusFilter);
+    }
+    if (!genre.empty()) {
+        filter.genres.push_back(genre);
+    }
+    if (!rating.empty()) {
+        filter.ratings.push_back(rating);
+    }
+    if (year > 0) {
+        filter.years.push_back(year);
+    }
+    
+    for (const Movie* movie : findMoviesByFilter(filter)) {
+        results.push_back(*movie);
+    }
+    return results;
+}
+
+// Movies having any of the values, an empty bitmap if none do
+template <typename Value>
+static RoaringBitmap uniteFacet(const map<Value, RoaringBitmap>& facet, const vector<Value>& values) {
+    RoaringBitmap matches;
+    for (const Value& value : values) {
+        auto it = facet.find(value);
+        if (it != facet.end()) {
+            matches = matches.unite(it->second);
+        }
+    }
+    return matches;
+}
+
+RoaringBitmap MovieService::matchFilter(const MovieFilter& filter) const {
+    vector<RoaringBitmap> facets;
+    if (!filter.statuses.empty()) {
+        facets.push_back(uniteFacet(statusFacet, filter.statuses));
+    }
+    if (!filter.genres.empty()) {
+        facets.push_back(uniteFacet(genreFacet, filter.genres));
+    }
+    if (!filter.ratings.empty()) {
+        facets.push_back(uniteFacet(ratingFacet, filter.ratings));
+    }
+    if (!filter.years.empty()) {
+        facets.push_back(uniteFacet(yearFacet, filter.years));
+    }
+    if (facets.empty()) {
+        return allMovies;
+    }
+    
+    // Smallest first, so every AND works on the fewest slots
+    sort(facets.begin(), facets.end(), [](const RoaringBitmap& a, const RoaringBitmap& b) {
+        return a.getCardinality() < b.getCardinality();
+    });
+    RoaringBitmap matches = facets[0];
+    for (size_t i = 1; i < facets.size() && !matches.isEmpty(); i++) {
+        matches = matches.intersect(facets[i]);
+    }
+    return matches;
+}
+
+vector<const Movie*> MovieService::findMoviesByFilter(const MovieFilter& filter) const {
+    vector<const Movie*> results;
+    for (uint32_t slot : matchFilter(filter).toSlots()) {
+        results.push_back(&movies[slot]);
+    }
+    return results;
+}
+
+// The facet's own selection is left out, so each value counts the movies selecting it would show
+map<string, int> MovieService::getFacetCounts(const string& facet, const MovieFilter& filter) const {
+    map<string, int> counts;
+    MovieFilter otherFacets = filter;
+    if (facet == "status") {
+        otherFacets.statuses.clear();
+        RoaringBitmap matches = matchFilter(otherFacets);
+        for (const auto& value : statusFacet) {
+            counts[toString(value.first)] = (int)value.second.intersectCount(matches);
         }
-        if (!genre.empty()) {
-            auto genres = movie.getGenres();
-            bool hasGenre = find(genres.begin(), genres.end(), genre) != genres.end();
-            if (!hasGenre) matches = false;
+    } else if (facet == "genre") {
+        otherFacets.genres.clear();
+        RoaringBitmap matches = matchFilter(otherFacets);
+        for (const auto& value : genreFacet) {
+            counts[value.first] = (int)value.second.intersectCount(matches);
         }
-        if (!rating.empty() && movie.getRating() != rating) {
-            matches = false;
+    } else if (facet == "rating") {
+        otherFacets.ratings.clear();
+        RoaringBitmap matches = matchFilter(otherFacets);
+        for (const auto& value : ratingFacet) {
+            counts[value.first] = (int)value.second.intersectCount(matches);
         }
-        // Year filtering would require parsing release_date
-        
-        if (matches) {
-            results.push_back(movie);
+    } else if (facet == "year") {
+        otherFacets.years.clear();
+        RoaringBitmap matches = matchFilter(otherFacets);
+        for (const auto& value : yearFacet) {
+            counts[to_string(value.first)] = (int)value.second.intersectCount(matches);
         }
     }
     
-    return results;
+    for (auto it = counts.begin(); it != counts.end();) {
+        if (it->second == 0) {
+            it = counts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return counts;
+}
+
+int MovieService::addMovieVersion(const MovieVersion& version) {
+    movieVersions.push_back(version);
+    movieVersions.back().setId(nextVersionId++);
+    versionIndex[movieVersions.back().getId()] = movieVersions.size() - 1;
+    versionsByMovie[version.getMovieId()].push_back(movieVersions.back().getId());
+    return movieVersions.back().getId();
+}
+
+bool MovieService::createMovieVersion(const MovieVersion& version) {
+    if (!findMovieById(version.getMovieId())) {
+        cout << "Error: Movie with ID " << version.getMovieId() << " not found!" << endl;
+        return false;
+    }
+    if (version.getType().empty() || version.getRuntime() <= 0) {
+        cout << "Error: Invalid movie version data!" << endl;
+        return false;
+    }
+    
+    int versionId = addMovieVersion(version);
+    cout << "Movie version created successfully with ID: " << versionId << endl;
+    return true;
+}
+
+const MovieVersion* MovieService::findMovieVersionById(int versionId) const {
+    auto it = versionIndex.find(versionId);
+    return it == versionIndex.end() ? nullptr : &movieVersions[it->second];
+}
+
+vector<int> MovieService::getVersionIds(int movieId) const {
+    auto it = versionsByMovie.find(movieId);
+    return it == versionsByMovie.end() ? vector<int>() : it->second;
 }
 
 bool MovieService::bulkImportMovies(const vector<Movie>& movieList) {
@@ -256,13 +1041,8 @@ bool MovieService::bulkImportMovies(const vector<Movie>& movieList) {
 }
 
 int MovieService::getActiveMovieCount() const {
-    int count = 0;
-    for (const auto& movie : movies) {
-        if (movie.getStatus() == "active") {
-            count++;
-        }
-    }
-    return count;
+    auto it = statusFacet.find(MovieStatus::ACTIVE);
+    return it == statusFacet.end() ? 0 : (int)it->second.getCardinality();
 }
 
 vector<Movie> MovieService::getTopRatedMovies(int limit) const {
@@ -343,14 +1123,15 @@ void MovieService::updateMovieDemo() {
     getline(cin, newTitle);
     
     if (!newTitle.empty()) {
-        movie->setTitle(newTitle);
-        cout << "Movie updated successfully!" << endl;
+        Movie updatedMovie = *movie;
+        updatedMovie.setTitle(newTitle);
+        updateMovie(movieId, updatedMovie); // Keeps the search index current
     }
 }
 
 void MovieService::searchMoviesDemo() {
     cout << "\n=== SEARCH MOVIES ===" << endl;
-    cout << "Enter search query (try 'aquafina' to find 'Aquaman'): ";
+    cout << "Enter search query (try 'aquamn' to find 'Aquaman'): ";
     
     string query;
     cin.ignore();
@@ -401,3 +1182,541 @@ void MovieService::showStatisticsDemo() {
         movie.displayInfo();
     }
 }
+
+// Catalog titles for the search benchmarks: 2048 word combinations, then numbered sequels
+static string benchmarkTitle(int i) {
+    static const char* firstWords[] = {"The", "Dark", "Last", "Lost", "Silent", "Red", "Golden", "Broken", 
+                                       "Hidden", "Wild", "Frozen", "Crimson", "Eternal", "Midnight", "Iron", "Blue"};
+    static const char* secondWords[] = {"Knight", "River", "Empire", "Garden", "Storm", "Horizon", "Kingdom", 
+                                        "Shadow", "Ocean", "Mountain", "Voyage", "Legacy", "Dragon", "Machine", 
+                                        "Planet", "Harbor"};
+    static const char* thirdWords[] = {"Rises", "Returns", "Awakens", "Falls", "Chronicles", "Protocol", 
+                                       "Reborn", "Origins"};
+    return string(firstWords[i % 16]) + " " + secondWords[i / 16 % 16] + " " + thirdWords[i / 256 % 8] + 
+           " " + to_string(i / 2048 + 1);
+}
+
+// The previous search score: exact 100, contains 80, else up to 60 by query characters found anywhere
+static int characterShareScore(const string& title, const string& query) {
+    if (title == query) {
+        return 100;
+    }
+    if (title.find(query) != string::npos) {
+        return 80;
+    }
+    int matches = 0;
+    for (char c : query) {
+        if (title.find(c) != string::npos) {
+            matches++;
+        }
+    }
+    return (matches * 60) / (int)query.length();
+}
+
+// Benchmark: indexed search against scanning and scoring every title, on a large catalog
+void MovieService::searchIndexBenchmarkDemo() {
+    cout << "\n=== MOVIE SEARCH INDEX BENCHMARK ===" << endl;
+    
+    const int catalogSize = 40000;
+    
+    MovieService catalog;
+    for (int i = 0; i < catalogSize; i++) {
+        Movie movie(benchmarkTitle(i), 90 + i % 90, "PG-13");
+        movie.setId(catalog.nextMovieId++);
+        if (i % 3 == 0) {
+            movie.setStatus(MovieStatus::ARCHIVED); // A third of the catalog is archived
+        }
+        catalog.addMovie(movie);
+    }
+    cout << "Catalog: " << catalogSize << " movies, " << catalog.titleTrigrams.getTrigramCount() 
+         << " distinct trigrams" << endl;
+    
+    const vector<string> queries = {"aquaman", "dark knight", "crimson dragon", "knigth", "frozen ocean rises 7", 
+                                    "midnigt harbr", "legacy", "storm", "iron machine reborn 12", "blu"};
+    const int repeats = 20;
+    
+    // Previous search: lowercase every title per query, score all of them, keep copies
+    auto start = chrono::steady_clock::now();
+    size_t scanResults = 0;
+    for (int r = 0; r < repeats; r++) {
+        for (const string& query : queries) {
+            string lowerQuery = normalizeText(query);
+            vector<pair<Movie, int>> scoredResults;
+            for (const auto& movie : catalog.movies) {
+                int score = characterShareScore(normalizeText(movie.getTitle()), lowerQuery);
+                if (score > 30) {
+                    scoredResults.push_back({movie, score});
+                }
+            }
+            scanResults += min(scoredResults.size(), size_t(10));
+        }
+    }
+    double scanMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / 
+                    (repeats * queries.size());
+    
+    start = chrono::steady_clock::now();
+    size_t indexResults = 0;
+    for (int r = 0; r < repeats; r++) {
+        for (const string& query : queries) {
+            indexResults += catalog.findMovies(query).size();
+        }
+    }
+    double indexMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / 
+                     (repeats * queries.size());
+    
+    cout << "Scan:  " << fixed << setprecision(3) << scanMs << " ms per query (" 
+         << scanResults / repeats << " results)" << endl;
+    cout << "Index: " << indexMs << " ms per query (" << indexResults / repeats << " results)" << endl;
+    
+    cout << "\nTop matches for 'midnigt harbr':" << endl;
+    for (const Movie* movie : catalog.findMovies("midnigt harbr", 3)) {
+        movie->displayInfo();
+    }
+}
+
+// Textbook edit distance table, one cell at a time, a swap of neighbours counting as one edit;
+// the baseline for FuzzyPattern
+static int tableDistance(const string& pattern, const string& text) {
+    vector<int> older(pattern.size() + 1), previous(pattern.size() + 1), current(pattern.size() + 1);
+    for (size_t i = 0; i <= pattern.size(); i++) {
+        previous[i] = (int)i;
+    }
+    int best = (int)pattern.size();
+    for (size_t j = 0; j < text.size(); j++) {
+        char c = text[j];
+        current[0] = 0; // A match may start anywhere
+        for (size_t i = 1; i <= pattern.size(); i++) {
+            current[i] = min(min(previous[i], current[i - 1]) + 1, previous[i - 1] + (pattern[i - 1] != c ? 1 : 0));
+            if (i > 1 && j > 0 && pattern[i - 1] == text[j - 1] && pattern[i - 2] == c) {
+                current[i] = min(current[i], older[i - 2] + 1);
+            }
+        }
+        best = min(best, current[pattern.size()]);
+        older.swap(previous);
+        previous.swap(current);
+    }
+    return best;
+}
+
+// Benchmark: does the right title come first for misspelled queries, and how fast are titles scored
+void MovieService::fuzzyMatchBenchmarkDemo() {
+    cout << "\n=== FUZZY MATCH BENCHMARK ===" << endl;
+    
+    // Relevance: well-known titles, each searched with typos a customer might make
+    const vector<string> titles = {"Aquaman", "Spider-Man", "The Batman", "Avatar", "Titanic", "Inception", 
+                                   "Interstellar", "The Godfather", "Pulp Fiction", "Parasite", "Joker", "Frozen", 
+                                   "Gladiator", "Oppenheimer", "Barbie", "Memento", "Whiplash", "Arrival", 
+                                   "Gravity", "The Matrix", "Toy Story", "Finding Nemo", "The Lion King", 
+                                   "Black Panther", "Iron Man", "Wonder Woman", "Top Gun", "Casablanca", 
+                                   "Vertigo", "Spirited Away", "La La Land", "Jurassic Park", "Star Wars", 
+                                   "The Terminator", "Back to the Future", "Ratatouille"};
+    MovieService catalog;
+    for (const string& title : titles) {
+        Movie movie(title, 120, "PG-13");
+        movie.setId(catalog.nextMovieId++);
+        catalog.addMovie(movie);
+    }
+    
+    // One typo per query: two letters swapped, one dropped, one replaced or one added
+    minstd_rand random(22);
+    vector<pair<string, size_t>> typoQueries; // query, index of the intended title
+    for (size_t t = 0; t < titles.size(); t++) {
+        string title = normalizeText(titles[t]);
+        for (int edit = 0; edit < 4; edit++) {
+            string query = title;
+            size_t position = 1 + random() % (title.size() - 2);
+            if (edit == 0) {
+                swap(query[position], query[position + 1]);
+            } else if (edit == 1) {
+                query.erase(position, 1);
+            } else if (edit == 2) {
+                query[position] = (char)('a' + (query[position] - 'a' + 1 + random() % 25) % 26);
+            } else {
+                query.insert(position, 1, (char)('a' + random() % 26));
+            }
+            if (query != title) {
+                typoQueries.push_back({query, t});
+            }
+        }
+    }
+    
+    // Scrambled titles (same letters, reversed) should not find the movie
+    vector<pair<string, size_t>> scrambledQueries;
+    for (size_t t = 0; t < titles.size(); t++) {
+        string title = normalizeText(titles[t]);
+        string scrambled(title.rbegin(), title.rend());
+        if (scrambled != title) {
+            scrambledQueries.push_back({scrambled, t});
+        }
+    }
+    
+    // rankOf(query) is the 1-based rank of the intended title, 0 if missing from the top 10
+    auto previousRank = [&](const string& query, size_t target) {
+        vector<pair<int, size_t>> scored; // -score, title index: catalog order among equal scores
+        for (size_t t = 0; t < titles.size(); t++) {
+            int score = characterShareScore(normalizeText(titles[t]), query);
+            if (score > 30) {
+                scored.push_back({-score, t});
+            }
+        }
+        sort(scored.begin(), scored.end());
+        for (size_t i = 0; i < scored.size() && i < 10; i++) {
+            if (scored[i].second == target) {
+                return (int)i + 1;
+            }
+        }
+        return 0;
+    };
+    auto indexedRank = [&](const string& query, size_t target) {
+        vector<const Movie*> found = catalog.findMovies(query);
+        for (size_t i = 0; i < found.size(); i++) {
+            if (found[i]->getTitle() == titles[target]) {
+                return (int)i + 1;
+            }
+        }
+        return 0;
+    };
+    
+    cout << "Relevance: " << typoQueries.size() << " misspelled and " << scrambledQueries.size() 
+         << " scrambled queries over " << titles.size() << " titles" << endl;
+    cout << setw(22) << "" << setw(10) << "Top 1" << setw(10) << "Top 10" << setw(8) << "MRR" 
+         << setw(14) << "Scrambled 1st" << endl;
+    for (int method = 0; method < 2; method++) {
+        int first = 0, topTen = 0, scrambledFirst = 0;
+        double reciprocalRanks = 0;
+        for (const auto& query : typoQueries) {
+            int rank = method == 0 ? previousRank(query.first, query.second) : indexedRank(query.first, query.second);
+            first += rank == 1;
+            topTen += rank > 0;
+            reciprocalRanks += rank > 0 ? 1.0 / rank : 0.0;
+        }
+        for (const auto& query : scrambledQueries) {
+            int rank = method == 0 ? previousRank(query.first, query.second) : indexedRank(query.first, query.second);
+            scrambledFirst += rank == 1;
+        }
+        cout << setw(22) << (method == 0 ? "Character share" : "Edit distance") 
+             << setw(9) << fixed << setprecision(1) << 100.0 * first / typoQueries.size() << "%" 
+             << setw(9) << 100.0 * topTen / typoQueries.size() << "%" 
+             << setw(8) << setprecision(3) << reciprocalRanks / typoQueries.size() 
+             << setw(14) << scrambledFirst << endl;
+    }
+    
+    // Latency: one compiled pattern against a large catalog's titles, then whole typo searches
+    const int catalogSize = 40000;
+    vector<string> catalogTitles;
+    for (int i = 0; i < catalogSize; i++) {
+        catalogTitles.push_back(normalizeText(benchmarkTitle(i)));
+    }
+    const string pattern = "midnigt harbr";
+    
+    auto start = chrono::steady_clock::now();
+    long tableTotal = 0;
+    for (const string& title : catalogTitles) {
+        tableTotal += tableDistance(pattern, title);
+    }
+    double tableUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    
+    start = chrono::steady_clock::now();
+    FuzzyPattern compiled(pattern);
+    long bitTotal = 0;
+    for (const string& title : catalogTitles) {
+        bitTotal += compiled.findDistance(title, (int)pattern.size());
+    }
+    double bitUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    
+    cout << "\nLatency: '" << pattern << "' against " << catalogSize << " titles" << endl;
+    cout << "Distance table:  " << setprecision(1) << tableUs * 1000 / catalogSize << " us per 1000 titles" << endl;
+    cout << "Bit-parallel:    " << bitUs * 1000 / catalogSize << " us per 1000 titles" 
+         << (bitTotal == tableTotal ? "" : " (Error: distances differ!)") << endl;
+    
+    MovieService largeCatalog;
+    for (int i = 0; i < catalogSize; i++) {
+        Movie movie(benchmarkTitle(i), 120, "PG-13");
+        movie.setId(largeCatalog.nextMovieId++);
+        largeCatalog.addMovie(movie);
+    }
+    const vector<string> typos = {"knigth", "midnigt harbr", "crimsn dragn", "goldne empire", "sielnt ocaen rises"};
+    const int repeats = 10;
+    start = chrono::steady_clock::now();
+    size_t found = 0;
+    for (int r = 0; r < repeats; r++) {
+        for (const string& query : typos) {
+            found += largeCatalog.findMovies(query).size();
+        }
+    }
+    double searchMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / 
+                      (repeats * typos.size());
+    cout << "Typo search:     " << setprecision(3) << searchMs << " ms per query (" 
+         << found / repeats << " results)" << endl;
+    
+    cout << (fuzzyMatchCheck() ? "Distances and swapped-letter searches check out." 
+                               : "Error: Fuzzy matching is broken!") << endl;
+}
+
+// FuzzyPattern must agree with the distance table, and a swap of neighbours must cost one edit and at most 4
+// trigrams, or findMovies would filter out the title the customer meant
+bool MovieService::fuzzyMatchCheck() {
+    minstd_rand random(2022);
+    const string letters = "abcd "; // Few letters, so texts hold many near matches
+    for (int i = 0; i < 3000; i++) {
+        string pattern(1 + random() % 64, ' ');
+        string text(random() % 96, ' ');
+        for (char& c : pattern) {
+            c = letters[random() % letters.size()];
+        }
+        for (char& c : text) {
+            c = letters[random() % letters.size()];
+        }
+        int maxDistance = random() % (pattern.size() + 1);
+        int expected = min(tableDistance(pattern, text), maxDistance + 1);
+        int distance = FuzzyPattern(pattern).findDistance(text, maxDistance);
+        if (distance != expected) {
+            cout << "Error: '" << pattern << "' in '" << text << "' is " << distance << " edits, the table says " 
+                 << expected << endl;
+            return false;
+        }
+    }
+    
+    const vector<string> titles = {"Joker", "Frozen", "Inception", "The Lion King", "Interstellar", 
+                                   "Back to the Future", "Spirited Away", "Jurassic Park", "The Godfather"};
+    MovieService catalog;
+    for (const string& title : titles) {
+        Movie movie(title, 120, "PG-13");
+        movie.setId(catalog.nextMovieId++);
+        catalog.addMovie(movie);
+    }
+    for (const string& title : titles) {
+        string normalized = normalizeText(title);
+        vector<uint32_t> titleTrigrams = TrigramIndex::getTrigrams(normalized);
+        for (size_t position = 0; position + 1 < normalized.size(); position++) {
+            string query = normalized;
+            swap(query[position], query[position + 1]);
+            if (query == normalized) {
+                continue;
+            }
+            
+            vector<uint32_t> trigrams = TrigramIndex::getTrigrams(query);
+            vector<uint32_t> shared;
+            set_intersection(trigrams.begin(), trigrams.end(), titleTrigrams.begin(), titleTrigrams.end(), 
+                             back_inserter(shared));
+            if (shared.size() + 4 < trigrams.size()) {
+                cout << "Error: '" << query << "' shares " << shared.size() << " of " << trigrams.size() 
+                     << " trigrams with '" << normalized << "'" << endl;
+                return false;
+            }
+            
+            vector<const Movie*> found = catalog.findMovies(query);
+            bool hasTitle = false;
+            for (const Movie* movie : found) {
+                hasTitle = hasTitle || movie->getTitle() == title;
+            }
+            if (!hasTitle) {
+                cout << "Error: '" << query << "' does not find " << title << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Benchmark: facet bitmaps against scanning every movie, and the facet counts a filter panel shows
+void MovieService::facetFilterBenchmarkDemo() {
+    cout << "\n=== FACET FILTER BENCHMARK ===" << endl;
+    
+    const vector<string> genres = {"Action", "Adventure", "Animation", "Comedy", "Crime", "Drama", "Fantasy", 
+                                   "Horror", "Romance", "Sci-Fi", "Thriller", "Documentary"};
+    const vector<string> ratings = {"G", "PG", "PG-13", "R", "NC-17"};
+    const int catalogSize = 40000;
+    
+    MovieService catalog;
+    minstd_rand random(23);
+    for (int i = 0; i < catalogSize; i++) {
+        Movie movie(benchmarkTitle(i), 90 + i % 90, ratings[random() % ratings.size()]);
+        movie.setId(catalog.nextMovieId++);
+        vector<string> movieGenres;
+        for (int g = 1 + random() % 3; g > 0; g--) {
+            const string& genre = genres[random() % genres.size()];
+            if (find(movieGenres.begin(), movieGenres.end(), genre) == movieGenres.end()) {
+                movieGenres.push_back(genre);
+            }
+        }
+        movie.setGenres(movieGenres);
+        time_t releaseDate;
+        TimeService::parseDate(to_string(1980 + random() % 46) + "-06-15", releaseDate);
+        movie.setReleaseDate(releaseDate);
+        if (i % 3 == 0) {
+            movie.setStatus(MovieStatus::ARCHIVED);
+        }
+        catalog.addMovie(movie);
+    }
+    
+    struct Query {
+        string status, genre, rating;
+        int year;
+    };
+    const vector<Query> queries = {{"active", "Action", "PG-13", 0}, {"", "Drama", "", 2010}, 
+                                   {"active", "Horror", "R", 2024}, {"archived", "", "G", 0}, 
+                                   {"", "Documentary", "", 0}};
+    const int repeats = 20;
+    
+    // Previous filter: every movie checked, its genres copied out for the membership test
+    auto start = chrono::steady_clock::now();
+    size_t scanMatches = 0;
+    for (int r = 0; r < repeats; r++) {
+        for (const Query& query : queries) {
+            MovieStatus status = MovieStatus::ACTIVE;
+            parseStatus(query.status, status);
+            for (const auto& movie : catalog.movies) {
+                if (!query.status.empty() && movie.getStatus() != status) {
+                    continue;
+                }
+                if (!query.genre.empty()) {
+                    auto movieGenres = movie.getGenres();
+                    if (find(movieGenres.begin(), movieGenres.end(), query.genre) == movieGenres.end()) {
+                        continue;
+                    }
+                }
+                if (!query.rating.empty() && movie.getRating() != query.rating) {
+                    continue;
+                }
+                if (query.year > 0 && getReleaseYear(movie) != query.year) {
+                    continue;
+                }
+                scanMatches++;
+            }
+        }
+    }
+    double scanMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / 
+                    (repeats * queries.size());
+    
+    start = chrono::steady_clock::now();
+    size_t bitmapMatches = 0;
+    for (int r = 0; r < repeats; r++) {
+        for (const Query& query : queries) {
+            MovieFilter filter;
+            MovieStatus status;
+            if (parseStatus(query.status, status)) {
+                filter.statuses.push_back(status);
+            }
+            if (!query.genre.empty()) {
+                filter.genres.push_back(query.genre);
+            }
+            if (!query.rating.empty()) {
+                filter.ratings.push_back(query.rating);
+            }
+            if (query.year > 0) {
+                filter.years.push_back(query.year);
+            }
+            bitmapMatches += catalog.findMoviesByFilter(filter).size();
+        }
+    }
+    double bitmapMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / 
+                      (repeats * queries.size());
+    
+    cout << "Catalog: " << catalogSize << " movies, " << catalog.genreFacet.size() << " genres, " 
+         << catalog.yearFacet.size() << " release years" << endl;
+    cout << "Scan:    " << fixed << setprecision(3) << scanMs << " ms per filter (" 
+         << scanMatches / repeats << " matches)" << endl;
+    cout << "Bitmaps: " << bitmapMs << " ms per filter (" << bitmapMatches / repeats << " matches)" << endl;
+    if (scanMatches != bitmapMatches) {
+        cout << "Error: Filters disagree!" << endl;
+    }
+    if (!facetBitmapCheck()) {
+        cout << "Error: Facet bitmaps are broken!" << endl;
+    }
+    
+    // A filter panel: active PG-13 movies from 2015-2020 that are Action or Comedy
+    MovieFilter panel;
+    panel.statuses = {MovieStatus::ACTIVE};
+    panel.genres = {"Action", "Comedy"};
+    panel.ratings = {"PG-13"};
+    panel.years = {2015, 2016, 2017, 2018, 2019, 2020};
+    
+    start = chrono::steady_clock::now();
+    size_t matches = catalog.matchFilter(panel).getCardinality();
+    map<string, int> genreCounts = catalog.getFacetCounts("genre", panel);
+    map<string, int> ratingCounts = catalog.getFacetCounts("rating", panel);
+    double panelMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    
+    cout << "\nActive, Action or Comedy, PG-13, 2015-2020: " << matches << " movies (" 
+         << panelMs << " ms with facet counts)" << endl;
+    cout << "Genres:";
+    for (const auto& count : genreCounts) {
+        cout << " " << count.first << " (" << count.second << ")";
+    }
+    cout << endl << "Ratings:";
+    for (const auto& count : ratingCounts) {
+        cout << " " << count.first << " (" << count.second << ")";
+    }
+    cout << endl;
+}
+
+// RoaringBitmap against std::set, while containers fill past ARRAY_LIMIT into bitsets and drain back into arrays
+// (below ARRAY_SHRINK_LIMIT)
+bool MovieService::facetBitmapCheck() {
+    minstd_rand random(2023);
+    RoaringBitmap bitmaps[2];
+    set<uint32_t> expected[2];
+    
+    auto agrees = [&](const char* phase) {
+        for (int b = 0; b < 2; b++) {
+            vector<uint32_t> slots(expected[b].begin(), expected[b].end());
+            if (bitmaps[b].toSlots() != slots || bitmaps[b].getCardinality() != slots.size() || 
+                bitmaps[b].isEmpty() != slots.empty()) {
+                cout << "Error: Bitmap " << b << " holds other slots than the set " << phase << endl;
+                return false;
+            }
+            for (int probe = 0; probe < 2000; probe++) {
+                uint32_t slot = random() % 200000;
+                if (bitmaps[b].contains(slot) != (expected[b].count(slot) > 0)) {
+                    cout << "Error: Bitmap " << b << " is wrong about slot " << slot << " " << phase << endl;
+                    return false;
+                }
+            }
+        }
+        
+        vector<uint32_t> both, either;
+        set_intersection(expected[0].begin(), expected[0].end(), expected[1].begin(), expected[1].end(), 
+                         back_inserter(both));
+        set_union(expected[0].begin(), expected[0].end(), expected[1].begin(), expected[1].end(), 
+                  back_inserter(either));
+        if (bitmaps[0].intersect(bitmaps[1]).toSlots() != both || bitmaps[0].intersectCount(bitmaps[1]) != both.size() || 
+            bitmaps[1].intersectCount(bitmaps[0]) != both.size() || bitmaps[0].unite(bitmaps[1]).toSlots() != either) {
+            cout << "Error: Bitmap AND / OR differ from the sets " << phase << endl;
+            return false;
+        }
+        return true;
+    };
+    
+    // Bitmap 0 grows dense in the first chunk, bitmap 1 stays sparse there; both reach into a third chunk
+    for (int i = 0; i < 30000; i++) {
+        uint32_t slot = random() % 3 == 0 ? 131072 + random() % 70000 : random() % 20000;
+        int b = slot < 65536 && random() % 8 == 0 ? 1 : 0;
+        bitmaps[b].add(slot);
+        expected[b].insert(slot);
+    }
+    if (!agrees("after adding")) {
+        return false;
+    }
+    
+    // Drain bitmap 0 below the array limit again and make bitmap 1 dense instead
+    for (int i = 0; i < 40000; i++) {
+        uint32_t slot = random() % 20000;
+        bitmaps[0].remove(slot);
+        expected[0].erase(slot);
+        bitmaps[1].add(slot);
+        expected[1].insert(slot);
+    }
+    if (!agrees("after removing")) {
+        return false;
+    }
+    
+    // Emptied bitmaps
+    for (int b = 0; b < 2; b++) {
+        for (uint32_t slot : expected[b]) {
+            bitmaps[b].remove(slot);
+        }
+        expected[b].clear();
+    }
+    return agrees("after emptying");
+}
@@ -3,11 +3,24 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <unordered_map>
+#include <map>
+#include <atomic>
 #include <ctime>
 #include <iostream>
+#include <cstdint>
+#include "TimeService.h"
 
 using namespace std;
 
+// Movie status: active <-> inactive, either -> archived (final)
+enum class MovieStatus : uint8_t { ACTIVE, INACTIVE, ARCHIVED };
+
+const char* toString(MovieStatus status);
+bool parseStatus(const string& text, MovieStatus& status); // Case-insensitive
+bool canTransition(MovieStatus from, MovieStatus to);
+
 // Base Entity class
 class Entity {
 protected:
@@ -16,14 +29,14 @@ protected:
     time_t updated_at;
     
 public:
-    Entity() : id(0), created_at(time(0)), updated_at(time(0)) {}
+    Entity() : id(0), created_at(TimeService::now()), updated_at(TimeService::now()) {}
     virtual ~Entity() {}
     
     int getId() const { return id; }
     void setId(int newId) { id = newId; }
     time_t getCreatedAt() const { return created_at; }
     time_t getUpdatedAt() const { return updated_at; }
-    void updateTimestamp() { updated_at = time(0); }
+    void updateTimestamp() { updated_at = TimeService::now(); }
 };
 
 // Movie class inheriting from Entity
@@ -39,7 +52,7 @@ private:
     vector<string> genres;
     string poster_url;
     string trailer_url;
-    string status;  // Active - Inactive - Archived
+    MovieStatus status;
     time_t release_date;
     string created_by;   //not yet// nhân viên phụ trách 
     string director;         //not yet// 
@@ -61,7 +74,7 @@ public:
     vector<string> getGenres() const { return genres; }
     string getPosterUrl() const { return poster_url; }
     string getTrailerUrl() const { return trailer_url; }
-    string getStatus() const { return status; }
+    MovieStatus getStatus() const { return status; }
     time_t getReleaseDate() const { return release_date; }
     string getCreatedBy() const { return created_by; }
     
@@ -76,7 +89,7 @@ public:
     void setGenres(const vector<string>& newGenres) { genres = newGenres; }
     void setPosterUrl(const string& newPosterUrl) { poster_url = newPosterUrl; }
     void setTrailerUrl(const string& newTrailerUrl) { trailer_url = newTrailerUrl; }
-    void setStatus(const string& newStatus) { status = newStatus; updateTimestamp(); }
+    bool setStatus(MovieStatus newStatus); // False if the transition is not allowed
     void setReleaseDate(time_t newReleaseDate) { release_date = newReleaseDate; }
     void setCreatedBy(const string& newCreatedBy) { created_by = newCreatedBy; }
     
@@ -113,13 +126,130 @@ public:
     void setFormatFlags(const vector<string>& newFlags) { format_flags = newFlags; }
 };
 
+// TrigramIndex - every 3-character substring of normalized text -> ascending slots containing it
+class TrigramIndex {
+private:
+    unordered_map<uint32_t, vector<size_t>> postings;
+
+public:
+    static vector<uint32_t> getTrigrams(const string& text); // Sorted, no duplicates
+    
+    void add(size_t slot, const vector<uint32_t>& trigrams);
+    void remove(size_t slot, const vector<uint32_t>& trigrams);
+    
+    // Slots containing every trigram, smallest posting list first
+    vector<size_t> intersect(const vector<uint32_t>& trigrams) const;
+    // counts[slot] += 1 per trigram the slot contains, slots seen for the first time go to touched
+    void countMatches(const vector<uint32_t>& trigrams, vector<uint16_t>& counts, vector<size_t>& touched) const;
+    size_t getTrigramCount() const { return postings.size(); }
+};
+
+// FuzzyPattern - a query compiled once for bit-parallel edit distance (Myers/Hyyro), 64 characters at most
+class FuzzyPattern {
+private:
+    static const int MAX_LENGTH = 64;
+    
+    uint64_t peq[256]; // Byte -> bit i set where pattern[i] is that byte
+    int length;
+
+public:
+    explicit FuzzyPattern(const string& pattern); // Longer patterns keep their first 64 characters
+    
+    int getLength() const { return length; }
+    // Fewest edits turning the pattern into some substring of text, maxDistance + 1 if above maxDistance
+    int findDistance(const string& text, int maxDistance) const;
+};
+
+// RoaringBitmap - compressed slot set: per 65536-slot chunk, a sorted array while sparse, a bitset when dense
+class RoaringBitmap {
+private:
+    static const int ARRAY_LIMIT = 4096; // Above this an array takes more room than the 8 KB bitset
+    // Removes turn a bitset back into an array only this far below, so add/remove around the limit cannot flap
+    static const int ARRAY_SHRINK_LIMIT = ARRAY_LIMIT / 2;
+    static const int BITSET_WORDS = 1024;
+    
+    struct Container {
+        uint16_t key; // High 16 bits of the slots
+        int cardinality;
+        vector<uint16_t> values; // Sorted low 16 bits while an array (cardinality <= ARRAY_LIMIT)
+        vector<uint64_t> words; // BITSET_WORDS words otherwise
+        
+        bool isBitset() const { return !words.empty(); }
+    };
+    
+    vector<Container> containers; // Ascending key
+    
+    static void toBitset(Container& container);
+    static void toArray(Container& container);
+    static Container intersectContainers(const Container& a, const Container& b);
+    static Container uniteContainers(const Container& a, const Container& b);
+    static int intersectCount(const Container& a, const Container& b);
+
+public:
+    void add(uint32_t slot);
+    void remove(uint32_t slot);
+    bool contains(uint32_t slot) const;
+    size_t getCardinality() const;
+    bool isEmpty() const { return containers.empty(); }
+    
+    RoaringBitmap intersect(const RoaringBitmap& other) const; // AND
+    RoaringBitmap unite(const RoaringBitmap& other) const; // OR
+    size_t intersectCount(const RoaringBitmap& other) const; // Cardinality of the AND, nothing is built
+    vector<uint32_t> toSlots() const; // Ascending
+};
+
+// MovieFilter struct - any of the listed values within a facet, every non-empty facet must match
+struct MovieFilter {
+    vector<MovieStatus> statuses;
+    vector<string> genres;
+    vector<string> ratings;
+    vector<int> years; // Release year
+};
+
+// MovieSearchEntry struct - a movie's searchable text, normalized once when it is indexed
+struct MovieSearchEntry {
+    bool indexed; // Archived movies are not searchable
+    vector<string> fields; // Normalized title, original title and slug, duplicates dropped
+    vector<uint32_t> trigrams; // Of all fields
+    
+    MovieSearchEntry() : indexed(false) {}
+};
+
 // MovieService class - Business Logic Layer
 class MovieService {
 private:
-    vector<Movie> movies;
+    deque<Movie> movies; // Slots never move, so search results can point into it
+    unordered_map<int, size_t> movieIndex; // movie_id -> slot
+    vector<MovieSearchEntry> searchEntries; // slot -> search text
+    TrigramIndex titleTrigrams; // Over the search text of indexed movies
+    
+    // Facet indexes: value -> slots of every movie with it, archived ones included
+    map<MovieStatus, RoaringBitmap> statusFacet;
+    map<string, RoaringBitmap> genreFacet;
+    map<string, RoaringBitmap> ratingFacet;
+    map<int, RoaringBitmap> yearFacet;
+    RoaringBitmap allMovies;
+    
     vector<MovieVersion> movieVersions;
+    unordered_map<int, size_t> versionIndex; // version id -> position
+    unordered_map<int, vector<int>> versionsByMovie; // movie_id -> version ids
     int nextMovieId;
+    int nextVersionId;
+    unsigned long revision; // Bumped on every movie change, so derived indexes know to update
+    map<unsigned long, int> changedMovies; // revision -> movie_id, only each movie's latest change
+    unordered_map<int, unsigned long> movieRevisions; // movie_id -> revision of its latest change
     
+    void bumpRevision(int movieId);
+    
+    void addMovie(const Movie& movie);
+    int addMovieVersion(const MovieVersion& version); // Returns the new version id
+    void indexMovie(size_t slot);
+    void unindexMovie(size_t slot);
+    void addToFacets(size_t slot);
+    void removeFromFacets(size_t slot);
+    static int getReleaseYear(const Movie& movie);
+    static int scoreMatch(const MovieSearchEntry& entry, const string& query, 
+                          const FuzzyPattern& pattern, int maxDistance);
     bool validateMovie(const Movie& movie) const;
     string generateSlug(const string& title) const;
     vector<Movie> heapSortMovies(vector<Movie> movieList, bool byRating = false) const;
@@ -131,10 +261,29 @@ public:
     bool createMovie(const Movie& movie);
     bool updateMovie(int movieId, const Movie& updatedMovie);
     bool archiveMovie(int movieId);
+    // Search text and facets are indexed; change movies through updateMovie and archiveMovie only
     Movie* findMovieById(int movieId);
+    const Movie* findMovieById(int movieId) const;
+    unsigned long getRevision() const { return revision; }
+    vector<int> getMoviesChangedSince(unsigned long sinceRevision) const; // Oldest change first
+    static string normalizeText(const string& text); // How titles and queries are compared
     vector<Movie> searchMovies(const string& query) const;
+    // Best first, no copies; stops early (results then incomplete) once *canceled is set
+    vector<const Movie*> findMovies(const string& query, size_t limit = 10, const atomic<bool>* canceled = nullptr) const;
     vector<Movie> filterMovies(const string& status = "", const string& genre = "", 
-                              const string& rating = "", int year = 0) const;
+                              const string& rating = "", int year = 0) const; // Status name, empty for any
+    
+    // Faceted filtering: bitmap ANDs across facets, ORs within one
+    RoaringBitmap matchFilter(const MovieFilter& filter) const;
+    vector<const Movie*> findMoviesByFilter(const MovieFilter& filter) const;
+    // value -> movies matching the filter with that value, e.g. genre "Action" -> 42; facet is
+    // "status", "genre", "rating" or "year"
+    map<string, int> getFacetCounts(const string& facet, const MovieFilter& filter = MovieFilter()) const;
+    
+    // Versions (formats) are what showtimes are scheduled for
+    bool createMovieVersion(const MovieVersion& version);
+    const MovieVersion* findMovieVersionById(int versionId) const;
+    vector<int> getVersionIds(int movieId) const;
     
     // Bulk operations
     bool bulkImportMovies(const vector<Movie>& movieList);
@@ -151,6 +300,13 @@ public:
     void archiveMovieDemo();
     void bulkImportDemo();
     void showStatisticsDemo();
+    void searchIndexBenchmarkDemo();
+    void fuzzyMatchBenchmarkDemo();
+    void facetFilterBenchmarkDemo();
+    
+    // Self-checks: false (with the reason on the console) when an invariant is broken
+    static bool fuzzyMatchCheck();
+    static bool facetBitmapCheck();
     
     // Utility
     void displayAllMovies() const;
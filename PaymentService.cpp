@@ -3,27 +3,68 @@
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include "TimeService.h"
+
+// Payment status
+const char* toString(PaymentStatus status) {
+    switch (status) {
+        case PaymentStatus::PENDING: return "pending";
+        case PaymentStatus::COMPLETED: return "completed";
+        case PaymentStatus::FAILED: return "failed";
+        case PaymentStatus::REFUNDED: return "refunded";
+        case PaymentStatus::VOIDED: return "voided";
+    }
+    return "unknown";
+}
+
+bool parseStatus(const string& text, PaymentStatus& status) {
+    string name = text;
+    transform(name.begin(), name.end(), name.begin(), ::tolower);
+    for (PaymentStatus candidate : {PaymentStatus::PENDING, PaymentStatus::COMPLETED, PaymentStatus::FAILED, 
+                                    PaymentStatus::REFUNDED, PaymentStatus::VOIDED}) {
+        if (name == toString(candidate)) {
+            status = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool canTransition(PaymentStatus from, PaymentStatus to) {
+    switch (from) {
+        case PaymentStatus::PENDING: return to != PaymentStatus::PENDING && to != PaymentStatus::REFUNDED;
+        case PaymentStatus::FAILED: return to == PaymentStatus::COMPLETED;
+        case PaymentStatus::COMPLETED: return to == PaymentStatus::REFUNDED;
+        default: return false;
+    }
+}
 
 // Payment base class implementation
-Payment::Payment() : id(0), order_id(0), amount(0.0), status("pending"),
-                     created_at(time(0)), updated_at(time(0)) {}
+Payment::Payment() : id(0), order_id(0), amount(0.0), status(PaymentStatus::PENDING),
+                     created_at(TimeService::now()), updated_at(TimeService::now()) {}
 
 Payment::Payment(int orderId, double paymentAmount) 
-    : id(0), order_id(orderId), amount(paymentAmount), status("pending"),
-      created_at(time(0)), updated_at(time(0)) {}
+    : id(0), order_id(orderId), amount(paymentAmount), status(PaymentStatus::PENDING),
+      created_at(TimeService::now()), updated_at(TimeService::now()) {}
+
+bool Payment::setStatus(PaymentStatus newStatus) {
+    if (!canTransition(status, newStatus)) {
+        return false;
+    }
+    status = newStatus;
+    updated_at = TimeService::now();
+    return true;
+}
 
 void Payment::displayInfo() const {
     cout << "Payment ID: " << id << " | Order: " << order_id 
          << " | Amount: $" << fixed << setprecision(2) << amount
-         << " | Method: " << getPaymentMethod() << " | Status: " << status << endl;
+         << " | Method: " << getPaymentMethod() << " | Status: " << toString(status) << endl;
     
-    char timeBuffer[80];
-    strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M", localtime(&created_at));
-    cout << "Created: " << timeBuffer;
+    cout << "Created: " << TimeService::formatDateTime(created_at);
     
     if (updated_at != created_at) {
-        strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M", localtime(&updated_at));
-        cout << " | Updated: " << timeBuffer;
+        cout << " | Updated: " << TimeService::formatDateTime(updated_at);
     }
     cout << endl;
 }
@@ -61,7 +102,7 @@ bool CashPayment::processPayment() {
         return false;
     }
     
-    setStatus("completed");
+    setStatus(PaymentStatus::COMPLETED);
     cout << "Cash payment processed successfully!" << endl;
     cout << "Change to give: $" << fixed << setprecision(2) << change_given << endl;
     
@@ -69,12 +110,12 @@ bool CashPayment::processPayment() {
 }
 
 bool CashPayment::refundPayment() {
-    if (status != "completed") {
+    if (!canTransition(status, PaymentStatus::REFUNDED)) {
         cout << "Error: Cannot refund non-completed payment!" << endl;
         return false;
     }
     
-    setStatus("refunded");
+    setStatus(PaymentStatus::REFUNDED);
     cout << "Cash refund of $" << fixed << setprecision(2) << amount 
          << " processed successfully!" << endl;
     
@@ -97,7 +138,7 @@ WalletPayment::WalletPayment() : Payment(), verification_required(true), verific
 
 WalletPayment::WalletPayment(int orderId, double paymentAmount, const string& walletType)
     : Payment(orderId, paymentAmount), wallet_type(walletType), 
-      verification_required(true), verification_timeout(time(0) + 300) { // 5 minutes timeout
+      verification_required(true), verification_timeout(TimeService::now() + 300) { // 5 minutes timeout
     qr_code = generateQrCode();
 }
 
@@ -116,12 +157,12 @@ bool WalletPayment::processPayment() {
         cout << "Waiting for payment verification..." << endl;
         // In real implementation, this would check with payment gateway
         if (verifyPayment()) {
-            setStatus("completed");
-            transaction_id = "TXN" + to_string(time(0));
+            setStatus(PaymentStatus::COMPLETED);
+            transaction_id = "TXN" + to_string(TimeService::now());
             cout << "Wallet payment completed! Transaction ID: " << transaction_id << endl;
             return true;
         } else {
-            setStatus("failed");
+            setStatus(PaymentStatus::FAILED);
             cout << "Payment verification failed or timed out!" << endl;
             return false;
         }
@@ -131,12 +172,12 @@ bool WalletPayment::processPayment() {
 }
 
 bool WalletPayment::refundPayment() {
-    if (status != "completed") {
+    if (!canTransition(status, PaymentStatus::REFUNDED)) {
         cout << "Error: Cannot refund non-completed payment!" << endl;
         return false;
     }
     
-    setStatus("refunded");
+    setStatus(PaymentStatus::REFUNDED);
     cout << "Wallet refund of $" << fixed << setprecision(2) << amount 
          << " initiated. Transaction ID: " << transaction_id << endl;
     
@@ -181,12 +222,12 @@ bool WalletPayment::verifyPayment() {
 }
 
 bool WalletPayment::isVerificationExpired() const {
-    return verification_required && time(0) > verification_timeout;
+    return verification_required && TimeService::now() > verification_timeout;
 }
 
 string WalletPayment::generateQrCode() const {
     stringstream ss;
-    ss << wallet_type << "_QR_" << order_id << "_" << time(0);
+    ss << wallet_type << "_QR_" << order_id << "_" << TimeService::now();
     return ss.str();
 }
 
@@ -217,24 +258,24 @@ bool CardPayment::processPayment() {
     bool success = (rand() % 10) > 1; // 90% success rate
     
     if (success) {
-        setStatus("completed");
-        authorization_code = "AUTH" + to_string(time(0));
+        setStatus(PaymentStatus::COMPLETED);
+        authorization_code = "AUTH" + to_string(TimeService::now());
         cout << "Card payment approved! Authorization: " << authorization_code << endl;
         return true;
     } else {
-        setStatus("failed");
+        setStatus(PaymentStatus::FAILED);
         cout << "Card payment declined!" << endl;
         return false;
     }
 }
 
 bool CardPayment::refundPayment() {
-    if (status != "completed") {
+    if (!canTransition(status, PaymentStatus::REFUNDED)) {
         cout << "Error: Cannot refund non-completed payment!" << endl;
         return false;
     }
     
-    setStatus("refunded");
+    setStatus(PaymentStatus::REFUNDED);
     cout << "Card refund of $" << fixed << setprecision(2) << amount 
          << " processed. Authorization: " << authorization_code << endl;
     
@@ -263,7 +304,7 @@ bool CardPayment::isValid() const {
 // PaymentService class implementation
 PaymentService::PaymentService() : nextPaymentId(1) {
     // Initialize with some sample data
-    srand(time(0)); // For random simulation
+    srand(TimeService::now()); // For random simulation
 }
 
 PaymentService::~PaymentService() {
@@ -286,13 +327,6 @@ bool PaymentService::validatePaymentAmount(double amount) const {
     return true;
 }
 
-string PaymentService::getCurrentDate() const {
-    time_t now = time(0);
-    char buffer[11];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%d", localtime(&now));
-    return string(buffer);
-}
-
 // Heap sort implementation for payments
 vector<Payment*> PaymentService::heapSortPayments(vector<Payment*> paymentList, bool byAmount) const {
     make_heap(paymentList.begin(), paymentList.end(), [byAmount](const Payment* a, const Payment* b) {
@@ -322,14 +356,18 @@ bool PaymentService::processPayment(Payment* payment) {
         return false;
     }
     
+    if (!canTransition(payment->getStatus(), PaymentStatus::COMPLETED)) {
+        cout << "Error: Cannot process a " << toString(payment->getStatus()) << " payment!" << endl;
+        return false;
+    }
+    
     payment->setId(nextPaymentId++);
     
     if (payment->processPayment()) {
         payments.push_back(payment);
         
         // Update daily totals
-        string date = getCurrentDate();
-        dailyTotals[date] += payment->getAmount();
+        dailyTotals[TimeService::dayKey(TimeService::now())] += payment->getAmount();
         
         cout << "Payment processed and recorded successfully!" << endl;
         return true;
@@ -348,8 +386,7 @@ bool PaymentService::refundPayment(int paymentId, const string& reason) {
     
     if (payment->refundPayment()) {
         // Update daily totals (subtract refunded amount)
-        string date = getCurrentDate();
-        dailyTotals[date] -= payment->getAmount();
+        dailyTotals[TimeService::dayKey(TimeService::now())] -= payment->getAmount();
         
         cout << "Refund processed successfully. Reason: " << reason << endl;
         return true;
@@ -365,8 +402,7 @@ bool PaymentService::voidPayment(int paymentId) {
         return false;
     }
     
-    if (payment->getStatus() == "pending") {
-        payment->setStatus("voided");
+    if (payment->setStatus(PaymentStatus::VOIDED)) {
         cout << "Payment voided successfully!" << endl;
         return true;
     } else {
@@ -406,9 +442,12 @@ vector<Payment*> PaymentService::getPaymentsByOrder(int orderId) const {
     return results;
 }
 
-vector<Payment*> PaymentService::getPaymentsByMethod(const string& method) const {
+vector<Payment*> PaymentService::getPaymentsByMethod(const string& method, const atomic<bool>* canceled) const {
     vector<Payment*> results;
     for (Payment* payment : payments) {
+        if (canceled && *canceled) {
+            break;
+        }
         if (payment->getPaymentMethod().find(method) != string::npos) {
             results.push_back(payment);
         }
@@ -416,7 +455,7 @@ vector<Payment*> PaymentService::getPaymentsByMethod(const string& method) const
     return results;
 }
 
-vector<Payment*> PaymentService::getPaymentsByStatus(const string& status) const {
+vector<Payment*> PaymentService::getPaymentsByStatus(PaymentStatus status) const {
     vector<Payment*> results;
     for (Payment* payment : payments) {
         if (payment->getStatus() == status) {
@@ -428,29 +467,37 @@ vector<Payment*> PaymentService::getPaymentsByStatus(const string& status) const
 
 vector<Payment*> PaymentService::getPaymentsByDate(const string& date) const {
     vector<Payment*> results;
+    time_t dayStart;
+    if (!TimeService::parseDate(date, dayStart)) {
+        return results;
+    }
+    
+    // The date becomes one time range, so each payment costs two comparisons
+    time_t dayEnd = TimeService::getDay(dayStart).end;
     for (Payment* payment : payments) {
-    char dateBuffer[11];
-    time_t createdAt = payment->getCreatedAt(); // Tạo biến tạm
-    strftime(dateBuffer, sizeof(dateBuffer), "%Y-%m-%d", localtime(&createdAt));
-    if (string(dateBuffer) == date) {
-        results.push_back(payment);
+        if (payment->getCreatedAt() >= dayStart && payment->getCreatedAt() < dayEnd) {
+            results.push_back(payment);
+        }
     }
-}
     return results;
 }
 
 double PaymentService::getDailyTotal(const string& date) const {
-    auto it = dailyTotals.find(date);
+    time_t dayStart;
+    if (!TimeService::parseDate(date, dayStart)) {
+        return 0.0;
+    }
+    auto it = dailyTotals.find(TimeService::dayKey(dayStart));
     return (it != dailyTotals.end()) ? it->second : 0.0;
 }
 
 double PaymentService::getWeeklyTotal() const {
     double total = 0.0;
-    time_t now = time(0);
+    time_t now = TimeService::now();
     time_t weekAgo = now - 7 * 24 * 3600;
     
     for (Payment* payment : payments) {
-        if (payment->getCreatedAt() >= weekAgo && payment->getStatus() == "completed") {
+        if (payment->getCreatedAt() >= weekAgo && payment->getStatus() == PaymentStatus::COMPLETED) {
             total += payment->getAmount();
         }
     }
@@ -460,11 +507,11 @@ double PaymentService::getWeeklyTotal() const {
 
 double PaymentService::getMonthlyTotal() const {
     double total = 0.0;
-    time_t now = time(0);
+    time_t now = TimeService::now();
     time_t monthAgo = now - 30 * 24 * 3600;
     
     for (Payment* payment : payments) {
-        if (payment->getCreatedAt() >= monthAgo && payment->getStatus() == "completed") {
+        if (payment->getCreatedAt() >= monthAgo && payment->getStatus() == PaymentStatus::COMPLETED) {
             total += payment->getAmount();
         }
     }
@@ -476,7 +523,7 @@ map<string, double> PaymentService::getPaymentMethodTotals() const {
     map<string, double> totals;
     
     for (Payment* payment : payments) {
-        if (payment->getStatus() == "completed") {
+        if (payment->getStatus() == PaymentStatus::COMPLETED) {
             string method = payment->getPaymentMethod();
             totals[method] += payment->getAmount();
         }
@@ -486,7 +533,7 @@ map<string, double> PaymentService::getPaymentMethodTotals() const {
 }
 
 vector<Payment*> PaymentService::getTopPayments(int limit) const {
-    vector<Payment*> completedPayments = getPaymentsByStatus("completed");
+    vector<Payment*> completedPayments = getPaymentsByStatus(PaymentStatus::COMPLETED);
     vector<Payment*> sortedPayments = heapSortPayments(completedPayments, true); // Sort by amount
     
     if (sortedPayments.size() > static_cast<size_t>(limit)) {
@@ -509,12 +556,12 @@ bool PaymentService::reconcileTransactions(const string& date) {
     for (Payment* payment : dayPayments) {
         totalProcessed += payment->getAmount();
         
-        if (payment->getStatus() == "completed") {
+        if (payment->getStatus() == PaymentStatus::COMPLETED) {
             totalCompleted += payment->getAmount();
             completedCount++;
-        } else if (payment->getStatus() == "failed") {
+        } else if (payment->getStatus() == PaymentStatus::FAILED) {
             failedCount++;
-        } else if (payment->getStatus() == "pending") {
+        } else if (payment->getStatus() == PaymentStatus::PENDING) {
             pendingCount++;
         }
     }
@@ -537,11 +584,11 @@ bool PaymentService::reconcileTransactions(const string& date) {
 }
 
 vector<Payment*> PaymentService::getPendingPayments() const {
-    return getPaymentsByStatus("pending");
+    return getPaymentsByStatus(PaymentStatus::PENDING);
 }
 
 vector<Payment*> PaymentService::getFailedPayments() const {
-    return getPaymentsByStatus("failed");
+    return getPaymentsByStatus(PaymentStatus::FAILED);
 }
 void PaymentService::processPaymentDemo() {
     cout << "[Demo] Process Payment Demo" << endl;
@@ -576,9 +623,7 @@ void PaymentService::displayPaymentSummary() const {
 }
 
 string PaymentService::formatTime(time_t timeValue) const {
-    char timeBuffer[80];
-    strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M", localtime(&timeValue));
-    return string(timeBuffer);
+    return TimeService::formatDateTime(timeValue);
 }
 
 string PaymentService::maskCardNumber(const string& cardNumber) const {
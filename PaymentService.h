@@ -6,16 +6,25 @@
 #include <ctime>
 #include <iostream>
 #include <map>
+#include <atomic>
+#include <cstdint>
 
 using namespace std;
 
+// Payment status: pending -> completed, failed or voided, failed -> completed (retry), completed -> refunded
+enum class PaymentStatus : uint8_t { PENDING, COMPLETED, FAILED, REFUNDED, VOIDED };
+
+const char* toString(PaymentStatus status);
+bool parseStatus(const string& text, PaymentStatus& status); // Case-insensitive
+bool canTransition(PaymentStatus from, PaymentStatus to);
+
 // Payment base class
 class Payment {
 protected:
     int id;
     int order_id;
     double amount;
-    string status; // pending, completed, failed, refunded
+    PaymentStatus status;
     string gateway_ref;
     time_t created_at;
     time_t updated_at;
@@ -29,7 +38,7 @@ public:
     int getId() const { return id; }
     int getOrderId() const { return order_id; }
     double getAmount() const { return amount; }
-    string getStatus() const { return status; }
+    PaymentStatus getStatus() const { return status; }
     string getGatewayRef() const { return gateway_ref; }
     time_t getCreatedAt() const { return created_at; }
     time_t getUpdatedAt() const { return updated_at; }
@@ -38,7 +47,7 @@ public:
     void setId(int newId) { id = newId; }
     void setOrderId(int newOrderId) { order_id = newOrderId; }
     void setAmount(double newAmount) { amount = newAmount; }
-    void setStatus(const string& newStatus) { status = newStatus; updated_at = time(0); }
+    bool setStatus(PaymentStatus newStatus); // False if the transition is not allowed
     void setGatewayRef(const string& newRef) { gateway_ref = newRef; }
     
     // Virtual methods
@@ -154,11 +163,10 @@ public:
 class PaymentService {
 private:
     vector<Payment*> payments;
-    map<string, double> dailyTotals; // date -> total amount
+    map<int, double> dailyTotals; // day key (YYYYMMDD) -> total amount
     int nextPaymentId;
     
     bool validatePaymentAmount(double amount) const;
-    string getCurrentDate() const;
     vector<Payment*> heapSortPayments(vector<Payment*> paymentList, bool byAmount = false) const;
 
 public:
@@ -178,9 +186,9 @@ public:
     // Payment retrieval
     Payment* findPaymentById(int paymentId);
     vector<Payment*> getPaymentsByOrder(int orderId) const;
-    vector<Payment*> getPaymentsByMethod(const string& method) const;
-    vector<Payment*> getPaymentsByStatus(const string& status) const;
-    vector<Payment*> getPaymentsByDate(const string& date) const;
+    vector<Payment*> getPaymentsByMethod(const string& method, const atomic<bool>* canceled = nullptr) const; // Stops early once *canceled is set
+    vector<Payment*> getPaymentsByStatus(PaymentStatus status) const;
+    vector<Payment*> getPaymentsByDate(const string& date) const; // YYYY-MM-DD
     
     // Financial reporting
     double getDailyTotal(const string& date) const;
@@ -1,30 +1,501 @@
 #include "SearchService.h"
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <memory>
 
-void SearchService::searchAll(const std::string& query) const {
-    std::cout << "\n--- Search Results for: " << query << " ---\n";
+// TitleTrie class implementation
+TitleTrie::TitleTrie() : nodes(1) {}
 
-    // Search movies
-    auto movies = movieService->searchMovies(query);
-    if (!movies.empty()) {
-        std::cout << "\nMovies:\n";
-        for (const auto& movie : movies) movie.displayInfo();
+void TitleTrie::clear() {
+    nodes.assign(1, Node());
+    movieNodes.clear();
+}
+
+int TitleTrie::findChild(int node, char c) const {
+    const std::vector<int>& children = nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), c, [this](int child, char value) {
+        return (unsigned char)nodes[child].label[0] < (unsigned char)value;
+    });
+    return it != children.end() && nodes[*it].label[0] == c ? *it : -1;
+}
+
+void TitleTrie::addTitle(int movieId, const std::string& title) {
+    for (size_t i = 0; i < title.size(); i++) {
+        if (title[i] != ' ' && (i == 0 || title[i - 1] == ' ')) {
+            insertKey(movieId, title.substr(i));
+        }
+    }
+}
+
+void TitleTrie::insertKey(int movieId, const std::string& key) {
+    int node = 0;
+    size_t position = 0;
+    while (position < key.size()) {
+        int child = findChild(node, key[position]);
+        if (child < 0) {
+            Node leaf;
+            leaf.label = key.substr(position);
+            leaf.parent = node;
+            nodes.push_back(leaf);
+            int leafIndex = (int)nodes.size() - 1;
+            std::vector<int>& children = nodes[node].children;
+            auto it = std::lower_bound(children.begin(), children.end(), key[position], [this](int other, char value) {
+                return (unsigned char)nodes[other].label[0] < (unsigned char)value;
+            });
+            children.insert(it, leafIndex);
+            node = leafIndex;
+            break;
+        }
+        
+        const std::string& label = nodes[child].label;
+        size_t common = 0;
+        while (common < label.size() && position + common < key.size() && label[common] == key[position + common]) {
+            common++;
+        }
+        if (common < label.size()) {
+            // The key leaves the edge halfway: a new node takes the shared part
+            Node middle;
+            middle.label = label.substr(0, common);
+            middle.parent = node;
+            middle.children.push_back(child);
+            std::string rest = label.substr(common);
+            nodes.push_back(middle);
+            int middleIndex = (int)nodes.size() - 1;
+            nodes[child].label = rest;
+            nodes[child].parent = middleIndex;
+            std::vector<int>& children = nodes[node].children;
+            *std::find(children.begin(), children.end(), child) = middleIndex; // Same first character
+            child = middleIndex;
+        }
+        node = child;
+        position += common;
+    }
+    
+    std::vector<int>& movieIds = nodes[node].movie_ids;
+    if (std::find(movieIds.begin(), movieIds.end(), movieId) == movieIds.end()) {
+        movieIds.push_back(movieId);
+        movieNodes[movieId].push_back(node);
     }
+}
+
+bool TitleTrie::heavier(int a, int b) const {
+    long weightA = getWeight(a);
+    long weightB = getWeight(b);
+    return weightA != weightB ? weightA > weightB : a < b;
+}
 
-    // Search showtimes
-    auto showtimes = showtimeService->searchShowtimes(query);
-    if (!showtimes.empty()) {
-        std::cout << "\nShowtimes:\n";
-        for (const auto& show : showtimes) show.displayInfo();
+// A node's top list is its own movies merged with its children's top lists
+void TitleTrie::refreshTop(int node) {
+    std::vector<int> candidates = nodes[node].movie_ids;
+    for (int child : nodes[node].children) {
+        candidates.insert(candidates.end(), nodes[child].top.begin(), nodes[child].top.end());
     }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    
+    size_t count = std::min(candidates.size(), TOP_COUNT);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), 
+                      [this](int a, int b) { return heavier(a, b); });
+    candidates.resize(count);
+    nodes[node].top.swap(candidates);
+}
 
-    // Search tickets
-    // (Bạn có thể thêm hàm search ticket theo ID hoặc tên phim nếu muốn)
+// Moves a movie whose weight grew up a node's top list; false if it stays out of the list,
+// then the ancestors hold the same heavier movies and cannot change either
+bool TitleTrie::promote(int node, int movieId) {
+    std::vector<int>& top = nodes[node].top;
+    auto it = std::find(top.begin(), top.end(), movieId);
+    if (it == top.end()) {
+        if (top.size() >= TOP_COUNT && !heavier(movieId, top.back())) {
+            return false;
+        }
+        if (top.size() >= TOP_COUNT) {
+            top.pop_back();
+        }
+        top.push_back(movieId);
+        it = top.end() - 1;
+    }
+    while (it != top.begin() && heavier(*it, *(it - 1))) {
+        std::iter_swap(it, it - 1);
+        --it;
+    }
+    return true;
+}
 
-    // Search payments
-    auto payments = paymentService->getPaymentsByMethod(query);
-    if (!payments.empty()) {
-        std::cout << "\nPayments:\n";
-        for (const auto& pay : payments) pay->displayInfo();
+void TitleTrie::rebuildTop() {
+    // Breadth-first order lists parents before children, so walk it backwards
+    std::vector<int> order(1, 0);
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int child : nodes[order[i]].children) {
+            order.push_back(child);
+        }
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        refreshTop(*it);
+    }
+}
+
+void TitleTrie::refreshPaths(const std::vector<int>& keyNodes) {
+    for (int node : keyNodes) {
+        for (int current = node; current >= 0; current = nodes[current].parent) {
+            refreshTop(current);
+        }
+    }
+}
+
+void TitleTrie::insertTitle(int movieId, const std::string& title) {
+    addTitle(movieId, title);
+    auto found = movieNodes.find(movieId);
+    if (found != movieNodes.end()) {
+        refreshPaths(found->second);
+    }
+}
+
+void TitleTrie::removeTitle(int movieId) {
+    auto found = movieNodes.find(movieId);
+    if (found == movieNodes.end()) {
+        return;
+    }
+    std::vector<int> keyNodes;
+    keyNodes.swap(found->second);
+    movieNodes.erase(found);
+    for (int node : keyNodes) {
+        std::vector<int>& movieIds = nodes[node].movie_ids;
+        movieIds.erase(std::remove(movieIds.begin(), movieIds.end(), movieId), movieIds.end());
+    }
+    refreshPaths(keyNodes);
+}
+
+void TitleTrie::addWeight(int movieId, long delta) {
+    weights[movieId] += delta;
+    auto found = movieNodes.find(movieId);
+    if (found == movieNodes.end()) {
+        return; // Not searchable (yet), the weight is used when it is added
+    }
+    for (int node : found->second) {
+        for (int current = node; current >= 0; current = nodes[current].parent) {
+            if (delta < 0) {
+                refreshTop(current); // A refund can let another movie back into the list
+            } else if (!promote(current, movieId)) {
+                break;
+            }
+        }
+    }
+}
+
+long TitleTrie::getWeight(int movieId) const {
+    auto it = weights.find(movieId);
+    return it == weights.end() ? 0 : it->second;
+}
+
+std::vector<int> TitleTrie::complete(const std::string& prefix, size_t limit) const {
+    int node = 0;
+    size_t position = 0;
+    while (position < prefix.size()) {
+        int child = findChild(node, prefix[position]);
+        if (child < 0) {
+            return std::vector<int>();
+        }
+        const std::string& label = nodes[child].label;
+        size_t length = std::min(label.size(), prefix.size() - position);
+        if (label.compare(0, length, prefix, position, length) != 0) {
+            return std::vector<int>();
+        }
+        node = child;
+        position += length;
+    }
+    
+    const std::vector<int>& top = nodes[node].top;
+    return std::vector<int>(top.begin(), top.begin() + std::min(limit, top.size()));
+}
+
+// SearchThreadPool class implementation
+SearchThreadPool::SearchThreadPool(size_t threadCount) : stopping(false) {
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.push_back(std::thread(&SearchThreadPool::workerLoop, this));
+    }
+}
+
+SearchThreadPool::~SearchThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    available.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void SearchThreadPool::submit(const std::function<void()>& task) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.push_back(task);
+    }
+    available.notify_one();
+}
+
+void SearchThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            available.wait(guard, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // Stopping and drained
+            }
+            task.swap(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+// SearchResult and SearchResults implementation
+const char* toString(SearchResultType type) {
+    switch (type) {
+        case SearchResultType::MOVIE: return "movie";
+        case SearchResultType::SHOWTIME: return "showtime";
+        case SearchResultType::TICKET: return "ticket";
+        case SearchResultType::ORDER: return "order";
+        case SearchResultType::PAYMENT: return "payment";
+    }
+    return "unknown";
+}
+
+size_t SearchResults::getPageCount(size_t pageSize) const {
+    return pageSize == 0 ? 0 : (hits.size() + pageSize - 1) / pageSize;
+}
+
+std::vector<SearchResult> SearchResults::getPage(size_t page, size_t pageSize) const {
+    size_t first = std::min(hits.size(), page * pageSize);
+    size_t last = std::min(hits.size(), first + pageSize);
+    return std::vector<SearchResult>(hits.begin() + first, hits.begin() + last);
+}
+
+// SearchService class implementation
+
+// Shared by searchAll and its searcher tasks
+struct FederatedQuery {
+    std::mutex lock;
+    std::condition_variable finished;
+    std::vector<std::vector<SearchResult>> source_hits;
+    std::vector<bool> answered; // Finished before the deadline
+    std::atomic<bool> canceled; // Set under lock at the deadline
+    size_t pending;
+    
+    FederatedQuery() : canceled(false), pending(0) {}
+};
+
+typedef std::vector<SearchResult> (SearchService::*SourceSearcher)(const std::string&, const std::atomic<bool>&) const;
+
+// Whole text 1.0, start of a word 0.8, anywhere else 0.6; both normalized
+static double textMatchScore(const std::string& text, const std::string& query) {
+    if (query.empty()) {
+        return 0.0;
+    }
+    if (text == query) {
+        return 1.0;
+    }
+    size_t position = text.find(query);
+    double score = position != std::string::npos ? 0.6 : 0.0;
+    for (; position != std::string::npos; position = text.find(query, position + 1)) {
+        if (position == 0 || text[position - 1] == ' ') {
+            return 0.8;
+        }
+    }
+    return score;
+}
+
+static std::string formatAmount(double amount) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(0) << amount;
+    return text.str();
+}
+
+std::vector<SearchResult> SearchService::searchMovieHits(const std::string& query, const std::atomic<bool>& canceled) const {
+    std::vector<SearchResult> hits;
+    std::string normalizedQuery = MovieService::normalizeText(query);
+    for (const Movie* movie : movieService->findMovies(query, MAX_SOURCE_HITS, &canceled)) {
+        if (canceled) {
+            break;
+        }
+        SearchResult hit;
+        hit.type = SearchResultType::MOVIE;
+        hit.id = std::to_string(movie->getId());
+        hit.title = movie->getTitle();
+        hit.detail = std::to_string(movie->getDuration()) + " min, " + movie->getRating() + ", " + 
+                     toString(movie->getStatus());
+        double textScore = textMatchScore(MovieService::normalizeText(movie->getTitle()), normalizedQuery);
+        hit.score = textScore > 0 ? textScore : 0.5; // Typo matches rank below every literal match
+        hits.push_back(hit);
+    }
+    return hits;
+}
+
+std::vector<SearchResult> SearchService::searchShowtimeHits(const std::string& query, const std::atomic<bool>& canceled) const {
+    std::vector<SearchResult> hits;
+    for (const Showtime& showtime : showtimeService->searchShowtimes(query, &canceled)) {
+        if (hits.size() == MAX_SOURCE_HITS || canceled) {
+            break;
+        }
+        SearchResult hit;
+        hit.type = SearchResultType::SHOWTIME;
+        hit.id = std::to_string(showtime.getId());
+        const MovieVersion* version = movieService->findMovieVersionById(showtime.getMovieVersionId());
+        const Movie* movie = version ? movieService->findMovieById(version->getMovieId()) : nullptr;
+        hit.title = movie ? movie->getTitle() : "Showtime " + hit.id;
+        hit.detail = TimeService::formatDateTime(showtime.getStartTime()) + ", " + showtime.getFormat() + 
+                     ", auditorium " + std::to_string(showtime.getAuditoriumId()) + ", " + toString(showtime.getStatus());
+        hit.score = hit.id == query ? 1.0 : 0.3; // Otherwise a format or status match
+        hits.push_back(hit);
+    }
+    return hits;
+}
+
+std::vector<SearchResult> SearchService::searchTicketHits(const std::string& query, const std::atomic<bool>& canceled) const {
+    std::vector<SearchResult> hits;
+    std::string ticketId = query;
+    std::transform(ticketId.begin(), ticketId.end(), ticketId.begin(), ::toupper);
+    Ticket ticket;
+    if (!canceled && bookingService->getTicketById(ticketId, ticket)) {
+        SearchResult hit;
+        hit.type = SearchResultType::TICKET;
+        hit.id = ticket.getTicketId();
+        hit.title = ticket.getMovieTitle();
+        hit.detail = "seat " + ticket.getSeatId() + ", " + TimeService::formatDateTime(ticket.getShowTime()) + 
+                     ", order " + std::to_string(ticket.getOrderId()) + ", " + toString(ticket.getStatus());
+        hit.score = 1.0;
+        hits.push_back(hit);
+    }
+    return hits;
+}
+
+std::vector<SearchResult> SearchService::searchOrderHits(const std::string& query, const std::atomic<bool>& canceled) const {
+    std::vector<SearchResult> hits;
+    std::string normalizedQuery = MovieService::normalizeText(query);
+    std::vector<Order> orders = bookingService->getOrdersByCustomer(query, MAX_SOURCE_HITS, &canceled); // Newest first
+    for (auto it = orders.begin(); it != orders.end() && !canceled; ++it) {
+        const Order* order = &*it;
+        SearchResult hit;
+        hit.type = SearchResultType::ORDER;
+        hit.id = std::to_string(order->getId());
+        hit.title = order->getCustomerName().empty() ? "Order " + hit.id : order->getCustomerName();
+        hit.detail = order->getCustomerPhone() + ", showtime " + std::to_string(order->getShowtimeId()) + ", " + 
+                     formatAmount(order->getTotalAmount()) + ", " + toString(order->getPaymentStatus());
+        hit.score = order->getCustomerPhone() == query ? 1.0 
+                                                       : textMatchScore(MovieService::normalizeText(order->getCustomerName()), 
+                                                                        normalizedQuery);
+        hits.push_back(hit);
+    }
+    return hits;
+}
+
+std::vector<SearchResult> SearchService::searchPaymentHits(const std::string& query, const std::atomic<bool>& canceled) const {
+    std::vector<SearchResult> hits;
+    for (const Payment* payment : paymentService->getPaymentsByMethod(query, &canceled)) {
+        if (hits.size() == MAX_SOURCE_HITS || canceled) {
+            break;
+        }
+        SearchResult hit;
+        hit.type = SearchResultType::PAYMENT;
+        hit.id = std::to_string(payment->getId());
+        hit.title = payment->getPaymentMethod() + " payment " + hit.id;
+        hit.detail = "order " + std::to_string(payment->getOrderId()) + ", " + formatAmount(payment->getAmount()) + 
+                     ", " + toString(payment->getStatus());
+        hit.score = 0.3; // A method matches a whole category of payments
+        hits.push_back(hit);
+    }
+    return hits;
+}
+
+// Sources are merged in a fixed order and stably sorted, so equal scores rank the same on every run
+// whichever searcher finishes first. The call never returns while a searcher still reads the services:
+// at the deadline the searchers are canceled and it waits for them to stop.
+SearchResults SearchService::searchAll(const std::string& query, int deadlineMs, bool parallel) const {
+    static const char* sourceNames[] = {"movies", "showtimes", "tickets", "orders", "payments"};
+    static const SourceSearcher searchers[] = {&SearchService::searchMovieHits, &SearchService::searchShowtimeHits, 
+                                               &SearchService::searchTicketHits, &SearchService::searchOrderHits, 
+                                               &SearchService::searchPaymentHits};
+    const size_t sourceCount = sizeof(searchers) / sizeof(searchers[0]);
+    
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(deadlineMs);
+    std::shared_ptr<FederatedQuery> state = std::make_shared<FederatedQuery>();
+    state->source_hits.resize(sourceCount);
+    state->answered.assign(sourceCount, false);
+    state->pending = sourceCount;
+    
+    for (size_t i = 0; i < sourceCount; i++) {
+        SourceSearcher searcher = searchers[i];
+        std::function<void()> task = [this, state, query, searcher, i]() {
+            std::vector<SearchResult> hits;
+            if (!state->canceled) {
+                hits = (this->*searcher)(query, state->canceled);
+            }
+            std::lock_guard<std::mutex> guard(state->lock);
+            state->answered[i] = !state->canceled;
+            if (state->answered[i]) {
+                state->source_hits[i].swap(hits);
+            }
+            state->pending--;
+            state->finished.notify_all();
+        };
+        if (parallel) {
+            searchPool.submit(task);
+        } else {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                state->canceled = true; // One after another, the deadline is checked between searchers
+            }
+            task();
+        }
+    }
+    
+    SearchResults results;
+    {
+        std::unique_lock<std::mutex> guard(state->lock);
+        if (!state->finished.wait_until(guard, deadline, [&state]() { return state->pending == 0; })) {
+            state->canceled = true;
+            state->finished.wait(guard, [&state]() { return state->pending == 0; });
+        }
+        for (size_t i = 0; i < sourceCount; i++) {
+            if (state->answered[i]) {
+                results.hits.insert(results.hits.end(), state->source_hits[i].begin(), state->source_hits[i].end());
+            } else {
+                results.timed_out.push_back(sourceNames[i]);
+            }
+        }
+    }
+    std::stable_sort(results.hits.begin(), results.hits.end(), [](const SearchResult& a, const SearchResult& b) {
+        return a.score > b.score;
+    });
+    
+    results.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return results;
+}
+
+void SearchService::printResults(const SearchResults& results, size_t page, size_t pageSize) const {
+    size_t pageCount = results.getPageCount(pageSize);
+    std::cout << "\n--- " << results.hits.size() << " results in " << std::fixed << std::setprecision(2) 
+              << results.elapsed_ms << " ms";
+    if (pageCount > 0) {
+        std::cout << ", page " << page + 1 << " of " << pageCount;
+    }
+    std::cout << " ---" << std::endl;
+    if (!results.timed_out.empty()) {
+        std::cout << "Missed the deadline:";
+        for (const std::string& source : results.timed_out) {
+            std::cout << " " << source;
+        }
+        std::cout << std::endl;
+    }
+    
+    for (const SearchResult& hit : results.getPage(page, pageSize)) {
+        std::cout << std::setw(10) << std::left << toString(hit.type) << std::right << std::setw(8) << hit.id 
+                  << "  " << hit.title << " (" << hit.detail << ")" << std::endl;
     }
 }
 
@@ -33,7 +504,19 @@ void SearchService::demonstrateSearch() const {
     std::string keyword;
     std::cin.ignore();
     std::getline(std::cin, keyword);
-    searchAll(keyword);
+    
+    const size_t pageSize = 10;
+    SearchResults results = searchAll(keyword);
+    printResults(results, 0, pageSize);
+    for (size_t page = 1; page < results.getPageCount(pageSize); page++) {
+        std::cout << "Next page? (y/n): ";
+        char choice;
+        std::cin >> choice;
+        if (choice != 'y' && choice != 'Y') {
+            break;
+        }
+        printResults(results, page, pageSize);
+    }
 }
 
 void SearchService::lookupByTicketId() const {
@@ -53,4 +536,257 @@ void SearchService::lookupByShowId() const {
     auto show = showtimeService->findShowtimeById(showId);
     if (show) show->displayInfo();
     else std::cout << "Showtime not found!\n";
-}
\ No newline at end of file
+}
+
+// Built once; after that only the movies changed since the last refresh are taken out and put back
+void SearchService::refreshTitleTrie() {
+    if (!trieBuilt) {
+        MovieFilter searchable;
+        searchable.statuses = {MovieStatus::ACTIVE, MovieStatus::INACTIVE};
+        for (const Movie* movie : movieService->findMoviesByFilter(searchable)) {
+            titleTrie.addTitle(movie->getId(), MovieService::normalizeText(movie->getTitle()));
+        }
+        titleTrie.rebuildTop();
+        trieBuilt = true;
+    } else if (trieRevision != movieService->getRevision()) {
+        for (int movieId : movieService->getMoviesChangedSince(trieRevision)) {
+            titleTrie.removeTitle(movieId);
+            const Movie* movie = movieService->findMovieById(movieId);
+            if (movie && (movie->getStatus() == MovieStatus::ACTIVE || movie->getStatus() == MovieStatus::INACTIVE)) {
+                titleTrie.insertTitle(movieId, MovieService::normalizeText(movie->getTitle()));
+            }
+        }
+    }
+    trieRevision = movieService->getRevision();
+}
+
+std::vector<TitleSuggestion> SearchService::autocomplete(const std::string& prefix, size_t limit, size_t showtimeCount) {
+    std::vector<int> movieIds;
+    std::vector<long> ticketsSold;
+    {
+        std::lock_guard<std::mutex> guard(trieMutex);
+        refreshTitleTrie();
+        movieIds = titleTrie.complete(MovieService::normalizeText(prefix), limit);
+        for (int movieId : movieIds) {
+            ticketsSold.push_back(titleTrie.getWeight(movieId));
+        }
+    }
+    
+    std::vector<TitleSuggestion> suggestions;
+    time_t now = TimeService::now();
+    for (size_t i = 0; i < movieIds.size(); i++) {
+        int movieId = movieIds[i];
+        const Movie* movie = movieService->findMovieById(movieId);
+        if (!movie) {
+            continue;
+        }
+        TitleSuggestion suggestion;
+        suggestion.movie_id = movieId;
+        suggestion.title = movie->getTitle();
+        suggestion.tickets_sold = ticketsSold[i];
+        if (showtimeCount > 0) {
+            suggestion.next_showtimes = showtimeService->getUpcomingShowtimes(movieService->getVersionIds(movieId), 
+                                                                             now, showtimeCount);
+        }
+        suggestions.push_back(suggestion);
+    }
+    return suggestions;
+}
+
+void SearchService::recordSeatSales(int showtimeId, int soldDelta) {
+    const Showtime* showtime = showtimeService->findShowtimeById(showtimeId);
+    if (!showtime) {
+        return;
+    }
+    const MovieVersion* version = movieService->findMovieVersionById(showtime->getMovieVersionId());
+    if (version) {
+        std::lock_guard<std::mutex> guard(trieMutex);
+        titleTrie.addWeight(version->getMovieId(), soldDelta);
+    }
+}
+
+void SearchService::autocompleteDemo() {
+    std::cout << "Type a partial title: ";
+    std::string typed;
+    std::cin.ignore();
+    std::getline(std::cin, typed);
+    
+    // Replay the typing one keystroke at a time, as the counter screen would see it
+    for (size_t length = 1; length <= typed.size(); length++) {
+        std::string prefix = typed.substr(0, length);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<TitleSuggestion> suggestions = autocomplete(prefix, 5, 0);
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        
+        std::cout << std::setw(20) << std::left << ("'" + prefix + "'") << std::right 
+                  << std::setw(8) << std::fixed << std::setprecision(1) << micros << " us:";
+        for (const auto& suggestion : suggestions) {
+            std::cout << " " << suggestion.title << ";";
+        }
+        std::cout << std::endl;
+    }
+    
+    std::vector<TitleSuggestion> suggestions = autocomplete(typed);
+    if (suggestions.empty()) {
+        std::cout << "No titles start with: " << typed << std::endl;
+        return;
+    }
+    std::cout << "\nSuggestions:" << std::endl;
+    for (const auto& suggestion : suggestions) {
+        std::cout << suggestion.title << " (" << suggestion.tickets_sold << " tickets sold)" << std::endl;
+        for (const auto& showtime : suggestion.next_showtimes) {
+            std::cout << "  Showtime " << showtime.getId() << ": " << TimeService::formatDateTime(showtime.getStartTime()) 
+                      << " " << showtime.getFormat() << ", auditorium " << showtime.getAuditoriumId() << std::endl;
+        }
+    }
+}
+
+// Words of the synthetic benchmark catalogs
+static const char* const titleAdjectives[] = {"silent", "golden", "broken", "hidden", "crimson", "eternal", "midnight", 
+                                              "iron", "frozen", "savage", "electric", "hollow", "velvet", "burning", 
+                                              "lucky", "secret"};
+static const char* const titleNouns[] = {"river", "empire", "garden", "storm", "horizon", "kingdom", "shadow", "ocean", 
+                                         "voyage", "legacy", "dragon", "machine", "planet", "harbor", "circus", "orchard"};
+static const char* const titleEndings[] = {"rising", "returns", "awakens", "falls", "chronicles", "protocol", "reborn", 
+                                           "origins"};
+
+// Benchmark: keystroke latency should not grow with the catalog
+void SearchService::autocompleteBenchmarkDemo() {
+    std::cout << "\n=== AUTOCOMPLETE BENCHMARK ===" << std::endl;
+    
+    std::cout << std::setw(10) << "Titles" << std::setw(12) << "Trie nodes" << std::setw(16) << "Keystroke (ns)" 
+              << std::setw(14) << "Sale (ns)" << std::endl;
+    for (int catalogSize : {1000, 10000, 100000}) {
+        std::minstd_rand random(24);
+        TitleTrie trie;
+        std::vector<std::string> titles;
+        for (int i = 0; i < catalogSize; i++) {
+            std::string title = std::string(titleAdjectives[random() % 16]) + " " + titleNouns[random() % 16] + " " + 
+                                titleEndings[random() % 8] + " " + std::to_string(i);
+            titles.push_back(title);
+            trie.addTitle(i, title);
+            trie.addWeight(i, random() % 1000);
+        }
+        trie.rebuildTop();
+        
+        // Prefixes a cashier would type: 1-8 characters from some word start of a title
+        std::vector<std::string> prefixes;
+        for (int i = 0; i < 10000; i++) {
+            const std::string& title = titles[random() % titles.size()];
+            size_t start = random() % 2 == 0 ? 0 : title.find(' ') + 1;
+            prefixes.push_back(title.substr(start, 1 + random() % 8));
+        }
+        
+        const int repeats = 20;
+        size_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; r++) {
+            for (const std::string& prefix : prefixes) {
+                found += trie.complete(prefix, 5).size();
+            }
+        }
+        double keystrokeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / 
+                             (repeats * prefixes.size());
+        
+        const int sales = 10000;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < sales; i++) {
+            trie.addWeight(random() % catalogSize, 1 + random() % 4);
+        }
+        double saleNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / sales;
+        
+        std::cout << std::setw(10) << catalogSize << std::setw(12) << trie.getNodeCount() 
+                  << std::setw(16) << std::fixed << std::setprecision(0) << keystrokeNs 
+                  << std::setw(14) << saleNs << (found > 0 ? "" : "  (Error: nothing found!)") << std::endl;
+    }
+}
+
+// Benchmark: the federated search costs about its slowest searcher instead of the sum of all of them
+void SearchService::federatedSearchBenchmarkDemo() {
+    std::cout << "\n=== FEDERATED SEARCH BENCHMARK ===" << std::endl;
+    
+    const int movieCount = 20000;
+    const int showtimeCount = 100;
+    const int seatsPerShowtime = 200;
+    const int orderCount = showtimeCount * seatsPerShowtime / 2; // Two seats each, every seat sold once
+    const int paymentCount = 20000;
+    const char* firstNames[] = {"An", "Binh", "Chi", "Dung", "Giang", "Hoa", "Khanh", "Linh", "Minh", "Nam", "Phuong", "Quan"};
+    const char* lastNames[] = {"Nguyen", "Tran", "Le", "Pham", "Hoang", "Vo", "Dang", "Bui"};
+    
+    MovieService movies;
+    ShowtimeService showtimes;
+    BookingService bookings;
+    PaymentService payments;
+    
+    // The create calls confirm every record on the console; keep that out of the way while loading
+    std::ostringstream loadLog;
+    std::streambuf* console = std::cout.rdbuf(loadLog.rdbuf());
+    for (int i = 0; i < movieCount; i++) {
+        std::string title = std::string(titleAdjectives[i % 16]) + " " + titleNouns[i / 16 % 16] + " " + 
+                            titleEndings[i / 256 % 8] + " " + std::to_string(i / 2048 + 1);
+        movies.createMovie(Movie(title, 90 + i % 90, "PG-13"));
+    }
+    
+    Auditorium auditorium(1, "Benchmark Hall", seatsPerShowtime);
+    bookings.registerAuditorium(auditorium);
+    for (int i = 0; i < showtimeCount; i++) {
+        Showtime showtime(1, auditorium.getId(), 0, 0);
+        showtime.setId(1 + i);
+        showtime.setSeatsTotal(seatsPerShowtime);
+        bookings.registerShowtime(showtime);
+    }
+    std::vector<Seat> seats = bookings.getSeatsForShowtime(1); // Every showtime has the same layout
+    for (int i = 0; i < orderCount; i++) {
+        int seat = 2 * (i / showtimeCount);
+        Order order(1, 1 + i % showtimeCount, {seats[seat].getSeatId(), seats[seat + 1].getSeatId()});
+        order.setCustomerName(std::string(firstNames[i % 12]) + " " + lastNames[i / 12 % 8]);
+        std::ostringstream phone;
+        phone << "09" << std::setfill('0') << std::setw(8) << i;
+        order.setCustomerPhone(phone.str());
+        bookings.createOrder(order);
+    }
+    for (int orderId = 1; orderId <= 100; orderId++) {
+        bookings.confirmBooking(orderId); // Issues TKT000001 onwards
+    }
+    for (int i = 0; i < paymentCount; i++) {
+        double amount = 90000 + (i % 5) * 10000;
+        payments.processPayment(new CashPayment(1 + i % orderCount, amount, amount, 1));
+    }
+    std::cout.rdbuf(console);
+    
+    std::cout << movieCount << " movies, " << orderCount << " orders, " << paymentCount << " payments" << std::endl;
+    
+    SearchService search(&movies, &showtimes, &bookings, &payments);
+    std::cout << "Search pool: " << search.searchPool.getThreadCount() << " threads" << std::endl;
+    const std::vector<std::string> queries = {"crimson harbor", "nguyen", "0900000042", "TKT000001", "cash", "2D"};
+    const int repeats = 20;
+    const int noDeadline = 60000;
+    
+    std::cout << std::setw(16) << std::left << "Query" << std::right << std::setw(8) << "Hits" 
+              << std::setw(18) << "Sequential (ms)" << std::setw(16) << "Parallel (ms)" << std::endl;
+    for (const std::string& query : queries) {
+        double sequentialMs = 0;
+        double parallelMs = 0;
+        size_t hits = 0;
+        for (int r = 0; r < repeats; r++) {
+            sequentialMs += search.searchAll(query, noDeadline, false).elapsed_ms;
+            SearchResults results = search.searchAll(query, noDeadline, true);
+            parallelMs += results.elapsed_ms;
+            hits = results.hits.size();
+        }
+        std::cout << std::setw(16) << std::left << query << std::right << std::setw(8) << hits 
+                  << std::setw(18) << std::fixed << std::setprecision(3) << sequentialMs / repeats 
+                  << std::setw(16) << parallelMs / repeats << std::endl;
+    }
+    
+    // A deadline tighter than the scans: the service scans see the cancel flag, so the call returns
+    // close to the deadline with whatever sources finished in time (often none with a small pool)
+    SearchResults results = search.searchAll("an", 1);
+    std::cout << "\nQuery 'an' with a 1 ms deadline: " << results.hits.size() << " hits in " 
+              << std::setprecision(2) << results.elapsed_ms << " ms, missed:";
+    for (const std::string& source : results.timed_out) {
+        std::cout << " " << source;
+    }
+    std::cout << (results.timed_out.empty() ? " none" : "") << std::endl;
+    search.printResults(search.searchAll("TKT000001"), 0, 5);
+}
@@ -3,26 +3,164 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include "MovieService.h"
 #include "ShowtimeService.h"
 #include "BookingService.h"
 #include "PaymentService.h"
 
+// TitleTrie - radix trie over normalized titles, entered from every word start ("batman" finds "the batman").
+// Every node keeps the heaviest movies below it, so a prefix is answered by one walk down the trie.
+class TitleTrie {
+private:
+    static const size_t TOP_COUNT = 10;
+    
+    struct Node {
+        std::string label; // Characters on the edge from the parent
+        int parent;
+        std::vector<int> children; // Sorted by the first character of their label
+        std::vector<int> movie_ids; // Keys ending here
+        std::vector<int> top; // Heaviest movies in this subtree, heaviest first, at most TOP_COUNT
+        
+        Node() : parent(-1) {}
+    };
+    
+    std::vector<Node> nodes; // nodes[0] is the root
+    std::unordered_map<int, std::vector<int>> movieNodes; // movie_id -> nodes where its keys end
+    std::unordered_map<int, long> weights; // movie_id -> popularity, kept across clear()
+    
+    int findChild(int node, char c) const;
+    void insertKey(int movieId, const std::string& key);
+    void refreshTop(int node);
+    void refreshPaths(const std::vector<int>& keyNodes); // Top lists from those nodes up to the root
+    bool promote(int node, int movieId);
+    bool heavier(int a, int b) const;
+
+public:
+    TitleTrie();
+    
+    void clear(); // Drops the titles, keeps the weights
+    void addTitle(int movieId, const std::string& title); // title normalized
+    void rebuildTop(); // After adding titles
+    void insertTitle(int movieId, const std::string& title); // addTitle that keeps the top lists current
+    void removeTitle(int movieId); // Its keys stop matching; emptied nodes stay
+    void addWeight(int movieId, long delta); // Updates the top lists on the movie's paths
+    long getWeight(int movieId) const;
+    std::vector<int> complete(const std::string& prefix, size_t limit) const; // At most TOP_COUNT
+    size_t getNodeCount() const { return nodes.size(); }
+};
+
+// TitleSuggestion struct - one type-ahead result
+struct TitleSuggestion {
+    int movie_id;
+    std::string title;
+    long tickets_sold;
+    std::vector<Showtime> next_showtimes;
+};
+
+// SearchThreadPool - fixed worker threads taking queued tasks in order
+class SearchThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable available;
+    bool stopping;
+    
+    void workerLoop();
+
+public:
+    explicit SearchThreadPool(size_t threadCount);
+    ~SearchThreadPool(); // Runs the queued tasks, then joins the workers
+    
+    void submit(const std::function<void()>& task);
+    size_t getThreadCount() const { return workers.size(); }
+};
+
+enum class SearchResultType { MOVIE, SHOWTIME, TICKET, ORDER, PAYMENT };
+
+const char* toString(SearchResultType type);
+
+// SearchResult struct - one hit of any type. Scores are comparable across types:
+// exact identifiers 1.0, titles and names by match quality, category matches (format, method) lowest.
+struct SearchResult {
+    SearchResultType type;
+    std::string id; // Entity id; ticket ids are text
+    std::string title;
+    std::string detail;
+    double score;
+};
+
+// SearchResults struct - one ranked list from every searcher that answered before the deadline
+struct SearchResults {
+    std::vector<SearchResult> hits; // Best first
+    std::vector<std::string> timed_out; // Sources left out because they missed the deadline
+    double elapsed_ms;
+    
+    SearchResults() : elapsed_ms(0) {}
+    
+    size_t getPageCount(size_t pageSize) const;
+    std::vector<SearchResult> getPage(size_t page, size_t pageSize) const; // page from 0
+};
+
 class SearchService {
 private:
     MovieService* movieService;
     ShowtimeService* showtimeService;
     BookingService* bookingService;
     PaymentService* paymentService;
+    
+    // Sales arrive on booking threads through recordSeatSales, so the trie is only touched under trieMutex
+    TitleTrie titleTrie; // Searchable movies, weighted by tickets sold
+    unsigned long trieRevision; // Movie catalog revision the trie is current with
+    bool trieBuilt;
+    mutable std::mutex trieMutex;
+    
+    void refreshTitleTrie(); // Caller holds trieMutex
+    
+    // Per-source searchers of the federated search, each capped at MAX_SOURCE_HITS.
+    // They stop early once canceled is set; what they return then is dropped.
+    static const size_t MAX_SOURCE_HITS = 50;
+    std::vector<SearchResult> searchMovieHits(const std::string& query, const std::atomic<bool>& canceled) const;
+    std::vector<SearchResult> searchShowtimeHits(const std::string& query, const std::atomic<bool>& canceled) const;
+    std::vector<SearchResult> searchTicketHits(const std::string& query, const std::atomic<bool>& canceled) const;
+    std::vector<SearchResult> searchOrderHits(const std::string& query, const std::atomic<bool>& canceled) const;
+    std::vector<SearchResult> searchPaymentHits(const std::string& query, const std::atomic<bool>& canceled) const;
+    
+    // Declared last: destroyed first, so no searcher runs against a half-destroyed service
+    mutable SearchThreadPool searchPool;
 
 public:
+    static const int DEFAULT_DEADLINE_MS = 250;
+
     SearchService(MovieService* m, ShowtimeService* s, BookingService* b, PaymentService* p)
-        : movieService(m), showtimeService(s), bookingService(b), paymentService(p) {}
+        : movieService(m), showtimeService(s), bookingService(b), paymentService(p), 
+          trieRevision(0), trieBuilt(false), 
+          searchPool(std::max(2u, std::min(5u, std::thread::hardware_concurrency()))) {}
 
-    void searchAll(const std::string& query) const;
+    // Federated search: the searchers run in parallel, those still running at the deadline are canceled
+    // and left out. Returns only after every searcher has stopped; the cancel flag reaches the service
+    // scans, so that is shortly after the deadline.
+    SearchResults searchAll(const std::string& query, int deadlineMs = DEFAULT_DEADLINE_MS, bool parallel = true) const;
+    void printResults(const SearchResults& results, size_t page, size_t pageSize) const;
     void demonstrateSearch() const;
     void lookupByTicketId() const;
     void lookupByShowId() const;
+    
+    // Type-ahead: most popular titles for a prefix, each with its next showtimes
+    std::vector<TitleSuggestion> autocomplete(const std::string& prefix, size_t limit = 5, size_t showtimeCount = 3);
+    void recordSeatSales(int showtimeId, int soldDelta); // Ticket sales are the popularity weights
+    void autocompleteDemo();
+    void autocompleteBenchmarkDemo();
+    void federatedSearchBenchmarkDemo();
 };
 
-#endif
\ No newline at end of file
+#endif
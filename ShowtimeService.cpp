@@ -3,6 +3,48 @@
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <climits>
+#include <limits>
+
+// Showtime status
+const char* toString(ShowtimeStatus status) {
+    switch (status) {
+        case ShowtimeStatus::SCHEDULED: return "scheduled";
+        case ShowtimeStatus::CANCELED: return "canceled";
+        case ShowtimeStatus::COMPLETED: return "completed";
+    }
+    return "unknown";
+}
+
+bool parseStatus(const string& text, ShowtimeStatus& status) {
+    string name = text;
+    transform(name.begin(), name.end(), name.begin(), ::tolower);
+    for (ShowtimeStatus candidate : {ShowtimeStatus::SCHEDULED, ShowtimeStatus::CANCELED, ShowtimeStatus::COMPLETED}) {
+        if (name == toString(candidate)) {
+            status = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool canTransition(ShowtimeStatus from, ShowtimeStatus to) {
+    return from == to || from == ShowtimeStatus::SCHEDULED;
+}
+
+// Empty matches any status (-1); false for a name that is not a status
+static bool parseStatusFilter(const string& text, int& status) {
+    ShowtimeStatus parsed;
+    if (text.empty()) {
+        status = -1;
+        return true;
+    }
+    if (!parseStatus(text, parsed)) {
+        return false;
+    }
+    status = (int)parsed;
+    return true;
+}
 
 // Auditorium class implementation
 Auditorium::Auditorium() : id(0), capacity(0) {}
@@ -25,32 +67,36 @@ bool Auditorium::supportsFormat(const string& format) const {
 // Showtime class implementation
 Showtime::Showtime() : id(0), movie_version_id(0), auditorium_id(0), 
                        start_time(0), end_time(0), price_template_id(0),
-                       seats_total(0), seats_available(0), hold_timeout_seconds(300),
-                       base_price(10.0) {
-    status = "scheduled";
+                       seats_total(0), seats_available(0), status(ShowtimeStatus::SCHEDULED),
+                       hold_timeout_seconds(300), base_price(10.0) {
     format = "2D";
 }
 
 Showtime::Showtime(int movieVersionId, int auditoriumId, time_t startTime, time_t endTime)
     : id(0), movie_version_id(movieVersionId), auditorium_id(auditoriumId),
       start_time(startTime), end_time(endTime), price_template_id(0),
-      seats_total(100), seats_available(100), hold_timeout_seconds(300),
-      base_price(10.0) {
-    status = "scheduled";
+      seats_total(100), seats_available(100), status(ShowtimeStatus::SCHEDULED),
+      hold_timeout_seconds(300), base_price(10.0) {
     format = "2D";
 }
 
+bool Showtime::setStatus(ShowtimeStatus newStatus) {
+    if (!canTransition(status, newStatus)) {
+        return false;
+    }
+    status = newStatus;
+    return true;
+}
+
 void Showtime::displayInfo() const {
     cout << "Showtime ID: " << id << " | Movie Version: " << movie_version_id
          << " | Auditorium: " << auditorium_id << " | Format: " << format
          << " | Available Seats: " << seats_available << "/" << seats_total
-         << " | Status: " << status << " | Price: $" << base_price << endl;
+         << " | Status: " << toString(status) << " | Price: $" << base_price << endl;
     
     // Display time information
-    char startBuffer[80], endBuffer[80];
-    strftime(startBuffer, sizeof(startBuffer), "%Y-%m-%d %H:%M", localtime(&start_time));
-    strftime(endBuffer, sizeof(endBuffer), "%Y-%m-%d %H:%M", localtime(&end_time));
-    cout << "Start: " << startBuffer << " | End: " << endBuffer << endl;
+    cout << "Start: " << TimeService::formatDateTime(start_time) 
+         << " | End: " << TimeService::formatDateTime(end_time) << endl;
 }
 
 bool Showtime::isValid() const {
@@ -64,8 +110,154 @@ double Showtime::getOccupancyRate() const {
     return (double)(seats_total - seats_available) / seats_total * 100.0;
 }
 
+// OccupancyStats struct implementation
+void OccupancyStats::add(int seatsTotal, int seatsSold, double rate) {
+    showtime_count++;
+    seats_total += seatsTotal;
+    seats_sold += seatsSold;
+    rate_sum += rate;
+}
+
+void OccupancyStats::remove(int seatsTotal, int seatsSold, double rate) {
+    showtime_count--;
+    seats_total -= seatsTotal;
+    seats_sold -= seatsSold;
+    rate_sum = showtime_count > 0 ? rate_sum - rate : 0.0; // Drop rounding drift once empty
+}
+
+// AuditoriumSchedule class implementation
+void AuditoriumSchedule::add(int showtimeId, time_t startTime, time_t endTime, size_t position) {
+    remove(showtimeId, startTime);
+    slots[make_pair(startTime, showtimeId)] = make_pair(endTime, position);
+    durations.insert(endTime - startTime);
+}
+
+void AuditoriumSchedule::remove(int showtimeId, time_t startTime) {
+    auto it = slots.find(make_pair(startTime, showtimeId));
+    if (it != slots.end()) {
+        durations.erase(durations.find(it->second.first - startTime));
+        slots.erase(it);
+    }
+}
+
+vector<size_t> AuditoriumSchedule::findOverlapping(time_t startTime, time_t endTime, int excludeShowtimeId) const {
+    vector<size_t> positions;
+    
+    // A slot overlapping the query starts before endTime and at most the longest slot before startTime
+    auto it = slots.lower_bound(make_pair(startTime - getLongestSlot(), INT_MIN));
+    for (; it != slots.end() && it->first.first < endTime; ++it) {
+        if (it->second.first > startTime && it->first.second != excludeShowtimeId) {
+            positions.push_back(it->second.second);
+        }
+    }
+    return positions;
+}
+
+void AuditoriumSchedule::getSlots(time_t fromTime, time_t toTime, 
+                                  vector<pair<pair<time_t, time_t>, int>>& result) const {
+    auto it = slots.lower_bound(make_pair(fromTime, INT_MIN));
+    for (; it != slots.end() && it->first.first < toTime; ++it) {
+        result.push_back(make_pair(make_pair(it->first.first, it->second.first), it->first.second));
+    }
+}
+
+bool AuditoriumSchedule::overlaps(time_t startTime, time_t endTime, int excludeShowtimeId) const {
+    auto it = slots.lower_bound(make_pair(startTime - getLongestSlot(), INT_MIN));
+    for (; it != slots.end() && it->first.first < endTime; ++it) {
+        if (it->second.first > startTime && it->first.second != excludeShowtimeId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ShowtimeColumns class implementation
+uint16_t ShowtimeColumns::encode(vector<string>& names, const string& value) {
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == value) {
+            return (uint16_t)i;
+        }
+    }
+    names.push_back(value);
+    return (uint16_t)(names.size() - 1);
+}
+
+
+void ShowtimeColumns::store(size_t position, const Showtime& showtime) {
+    if (position >= size()) {
+        size_t rows = position + 1;
+        start_times.resize(rows);
+        end_times.resize(rows);
+        auditorium_ids.resize(rows);
+        movie_version_ids.resize(rows);
+        statuses.resize(rows);
+        format_codes.resize(rows);
+        seats_total.resize(rows);
+        seats_available.resize(rows);
+    }
+    start_times[position] = showtime.getStartTime();
+    end_times[position] = showtime.getEndTime();
+    auditorium_ids[position] = showtime.getAuditoriumId();
+    movie_version_ids[position] = showtime.getMovieVersionId();
+    statuses[position] = showtime.getStatus();
+    format_codes[position] = encode(format_names, showtime.getFormat());
+    seats_total[position] = showtime.getSeatsTotal();
+    seats_available[position] = showtime.getSeatsAvailable();
+}
+
+// Branch-free: every row is tested and its position written, but only matches advance the output
+void ShowtimeColumns::filter(int status, int auditoriumId, time_t fromTime, time_t toTime, 
+                             vector<size_t>& positions) const {
+    size_t rows = size();
+    size_t first = positions.size();
+    positions.resize(first + rows);
+    size_t* out = positions.data() + first;
+    
+    bool anyStatus = status < 0;
+    bool anyAuditorium = auditoriumId <= 0;
+    ShowtimeStatus wanted = anyStatus ? ShowtimeStatus::SCHEDULED : (ShowtimeStatus)status;
+    const ShowtimeStatus* rowStatuses = statuses.data();
+    const int* auditoriums = auditorium_ids.data();
+    const time_t* starts = start_times.data();
+    
+    size_t count = 0;
+    for (size_t i = 0; i < rows; i++) {
+        bool matches = (anyStatus | (rowStatuses[i] == wanted)) & 
+                       (anyAuditorium | (auditoriums[i] == auditoriumId)) &
+                       (starts[i] >= fromTime) & (starts[i] <= toTime);
+        out[count] = i;
+        count += matches;
+    }
+    positions.resize(first + count);
+}
+
+void ShowtimeColumns::search(const string& text, vector<size_t>& positions) const {
+    // Match the status names and the format dictionary once, then scan codes
+    uint8_t statusMatches[3];
+    for (int code = 0; code < 3; code++) {
+        statusMatches[code] = string(toString((ShowtimeStatus)code)).find(text) != string::npos;
+    }
+    vector<uint8_t> formatMatches(format_names.size());
+    for (size_t code = 0; code < format_names.size(); code++) {
+        formatMatches[code] = format_names[code].find(text) != string::npos;
+    }
+    
+    size_t rows = size();
+    size_t first = positions.size();
+    positions.resize(first + rows);
+    size_t* out = positions.data() + first;
+    
+    size_t count = 0;
+    for (size_t i = 0; i < rows; i++) {
+        out[count] = i;
+        count += statusMatches[(int)statuses[i]] | formatMatches[format_codes[i]];
+    }
+    positions.resize(first + count);
+}
+
 // ShowtimeService class implementation
-ShowtimeService::ShowtimeService() : nextShowtimeId(1), nextAuditoriumId(1) {
+ShowtimeService::ShowtimeService(const Clock& clock)
+    : columnarScans(true), nextShowtimeId(1), nextAuditoriumId(1), timeSource(clock) {
     // Initialize with sample auditoriums
     Auditorium aud1(nextAuditoriumId++, "Theater 1", 100);
     aud1.setRoomType("Standard");
@@ -79,10 +271,19 @@ ShowtimeService::ShowtimeService() : nextShowtimeId(1), nextAuditoriumId(1) {
     Auditorium aud3(nextAuditoriumId++, "4DX Theater", 80);
     aud3.setRoomType("4DX");
     aud3.setFormatSupport({"2D", "3D", "4DX"});
+    aud3.setSeatMap("{\"rows\": ["
+                    "{\"label\": \"A\", \"seats\": \"SSS_SSSS_SSS\"},"
+                    "{\"label\": \"B\", \"seats\": \"SSS_SSSS_SSS\"},"
+                    "{\"label\": \"C\", \"seats\": \"SSS_SSSS_SSS\"},"
+                    "{\"label\": \"D\", \"seats\": \"SSS_VVVV_SSS\"},"
+                    "{\"label\": \"E\", \"seats\": \"SSS_VVVV_SSS\"},"
+                    "{\"label\": \"F\", \"seats\": \"SSS_CCCC_SSS\"},"
+                    "{\"label\": \"G\", \"seats\": \"SSS_CCCC_SSS\"},"
+                    "{\"label\": \"H\", \"seats\": \"WWS_SSSS_SWW\"}]}");
     auditoriums.push_back(aud3);
     
     // Initialize with sample showtimes
-    time_t now = time(0);
+    time_t now = timeSource.now();
     time_t tomorrow = now + 24 * 3600;
     
     Showtime show1(1, 1, tomorrow + 3600, tomorrow + 5400); // 1 hour from tomorrow, 2.5 hours duration
@@ -92,6 +293,7 @@ ShowtimeService::ShowtimeService() : nextShowtimeId(1), nextAuditoriumId(1) {
     show1.setSeatsTotal(100);
     show1.setSeatsAvailable(85);
     showtimes.push_back(show1);
+    indexShowtime(showtimes.size() - 1);
     
     Showtime show2(1, 2, tomorrow + 7200, tomorrow + 9600); // 2 hours from tomorrow
     show2.setId(nextShowtimeId++);
@@ -100,6 +302,7 @@ ShowtimeService::ShowtimeService() : nextShowtimeId(1), nextAuditoriumId(1) {
     show2.setSeatsTotal(150);
     show2.setSeatsAvailable(120);
     showtimes.push_back(show2);
+    indexShowtime(showtimes.size() - 1);
 }
 
 bool ShowtimeService::validateShowtime(const Showtime& showtime) const {
@@ -128,7 +331,7 @@ bool ShowtimeService::validateShowtime(const Showtime& showtime) const {
     }
     
     // Check if start time is in the future
-    time_t now = time(0);
+    time_t now = timeSource.now();
     if (showtime.getStartTime() <= now) {
         cout << "Error: Cannot create showtime in the past!" << endl;
         return false;
@@ -137,25 +340,89 @@ bool ShowtimeService::validateShowtime(const Showtime& showtime) const {
     return true;
 }
 
-bool ShowtimeService::checkTimeConflict(int auditoriumId, time_t startTime, time_t endTime, int excludeShowtimeId) const {
-    for (const auto& showtime : showtimes) {
-        if (showtime.getAuditoriumId() == auditoriumId && 
-            showtime.getId() != excludeShowtimeId &&
-            showtime.getStatus() != "canceled") {
-            
-            // Check for overlap with 30-minute buffer
-            time_t bufferTime = 30 * 60; // 30 minutes
-            time_t existingStart = showtime.getStartTime() - bufferTime;
-            time_t existingEnd = showtime.getEndTime() + bufferTime;
-            
-            if ((startTime >= existingStart && startTime < existingEnd) ||
-                (endTime > existingStart && endTime <= existingEnd) ||
-                (startTime <= existingStart && endTime >= existingEnd)) {
-                return true; // Conflict found
-            }
+void ShowtimeService::indexShowtime(size_t position) {
+    const Showtime& showtime = showtimes[position];
+    showtimePositions[showtime.getId()] = position;
+    startTimeIndex[make_pair(showtime.getStartTime(), showtime.getId())] = position;
+    columns.store(position, showtime);
+    rankShowtime(position);
+    if (showtime.getStatus() != ShowtimeStatus::CANCELED) {
+        schedules[showtime.getAuditoriumId()].add(showtime.getId(), showtime.getStartTime(), 
+                                                  showtime.getEndTime(), position);
+        versionStartIndex[showtime.getMovieVersionId()].insert(make_pair(showtime.getStartTime(), showtime.getId()));
+    }
+}
+
+void ShowtimeService::unindexShowtime(size_t position) {
+    const Showtime& showtime = showtimes[position];
+    startTimeIndex.erase(make_pair(showtime.getStartTime(), showtime.getId()));
+    unrankShowtime(position);
+    auto it = schedules.find(showtime.getAuditoriumId());
+    if (it != schedules.end()) {
+        it->second.remove(showtime.getId(), showtime.getStartTime());
+    }
+    auto versionIt = versionStartIndex.find(showtime.getMovieVersionId());
+    if (versionIt != versionStartIndex.end()) {
+        versionIt->second.erase(make_pair(showtime.getStartTime(), showtime.getId()));
+        if (versionIt->second.empty()) {
+            versionStartIndex.erase(versionIt);
         }
     }
-    return false; // No conflict
+}
+
+// The ranking and the occupancy totals keep what the showtime was counted under, so it can be
+// taken back out after the showtime changed
+void ShowtimeService::rankShowtime(size_t position) {
+    const Showtime& showtime = showtimes[position];
+    if (occupancyEntries.size() <= position) {
+        occupancyEntries.resize(position + 1);
+    }
+    OccupancyEntry& entry = occupancyEntries[position];
+    entry.rate = showtime.getOccupancyRate();
+    entry.seats_total = showtime.getSeatsTotal();
+    entry.seats_sold = showtime.getSeatsTotal() - showtime.getSeatsAvailable();
+    entry.auditorium_id = showtime.getAuditoriumId();
+    entry.day_start = TimeService::dayStart(showtime.getStartTime());
+    
+    occupancyRanking.insert(make_pair(-entry.rate, showtime.getId()));
+    occupancyTotals.add(entry.seats_total, entry.seats_sold, entry.rate);
+    auditoriumOccupancy[entry.auditorium_id].add(entry.seats_total, entry.seats_sold, entry.rate);
+    dailyOccupancy[entry.day_start].add(entry.seats_total, entry.seats_sold, entry.rate);
+}
+
+void ShowtimeService::unrankShowtime(size_t position) {
+    if (position >= occupancyEntries.size()) {
+        return;
+    }
+    const OccupancyEntry& entry = occupancyEntries[position];
+    occupancyRanking.erase(make_pair(-entry.rate, showtimes[position].getId()));
+    occupancyTotals.remove(entry.seats_total, entry.seats_sold, entry.rate);
+    
+    auto auditoriumIt = auditoriumOccupancy.find(entry.auditorium_id);
+    if (auditoriumIt != auditoriumOccupancy.end()) {
+        auditoriumIt->second.remove(entry.seats_total, entry.seats_sold, entry.rate);
+        if (auditoriumIt->second.showtime_count == 0) {
+            auditoriumOccupancy.erase(auditoriumIt);
+        }
+    }
+    auto dayIt = dailyOccupancy.find(entry.day_start);
+    if (dayIt != dailyOccupancy.end()) {
+        dayIt->second.remove(entry.seats_total, entry.seats_sold, entry.rate);
+        if (dayIt->second.showtime_count == 0) {
+            dailyOccupancy.erase(dayIt);
+        }
+    }
+}
+
+bool ShowtimeService::checkTimeConflict(int auditoriumId, time_t startTime, time_t endTime, int excludeShowtimeId) const {
+    auto it = schedules.find(auditoriumId);
+    if (it == schedules.end()) {
+        return false;
+    }
+    
+    // Widening the new showtime by the buffer on both sides keeps it clear of existing ones
+    return it->second.overlaps(startTime - CLEANING_BUFFER_SECONDS, endTime + CLEANING_BUFFER_SECONDS, 
+                               excludeShowtimeId);
 }
 
 // Heap sort implementation for showtimes
@@ -178,15 +445,21 @@ vector<Showtime> ShowtimeService::heapSortShowtimes(vector<Showtime> showtimeLis
 }
 
 bool ShowtimeService::createAuditorium(const Auditorium& auditorium) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     Auditorium newAuditorium = auditorium;
     newAuditorium.setId(nextAuditoriumId++);
     auditoriums.push_back(newAuditorium);
     
+    if (auditoriumListener) {
+        auditoriumListener(newAuditorium);
+    }
+    
     cout << "Auditorium created successfully with ID: " << newAuditorium.getId() << endl;
     return true;
 }
 
 Auditorium* ShowtimeService::findAuditoriumById(int auditoriumId) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     for (auto& auditorium : auditoriums) {
         if (auditorium.getId() == auditoriumId) {
             return &auditorium;
@@ -196,10 +469,12 @@ Auditorium* ShowtimeService::findAuditoriumById(int auditoriumId) {
 }
 
 vector<Auditorium> ShowtimeService::getAllAuditoriums() const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     return auditoriums;
 }
 
 bool ShowtimeService::createShowtime(const Showtime& showtime) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     if (!validateShowtime(showtime)) {
         return false;
     }
@@ -221,12 +496,18 @@ bool ShowtimeService::createShowtime(const Showtime& showtime) {
     }
     
     showtimes.push_back(newShowtime);
+    indexShowtime(showtimes.size() - 1);
+    
+    if (showtimeListener) {
+        showtimeListener(newShowtime);
+    }
     
     cout << "Showtime created successfully with ID: " << newShowtime.getId() << endl;
     return true;
 }
 
 bool ShowtimeService::updateShowtime(int showtimeId, const Showtime& updatedShowtime) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     Showtime* showtime = findShowtimeById(showtimeId);
     if (!showtime) {
         cout << "Error: Showtime with ID " << showtimeId << " not found!" << endl;
@@ -240,6 +521,7 @@ bool ShowtimeService::updateShowtime(int showtimeId, const Showtime& updatedShow
         // Only allow certain updates when tickets are sold
         showtime->setBasePrice(updatedShowtime.getBasePrice());
         showtime->setFormat(updatedShowtime.getFormat());
+        columns.store(showtime - &showtimes[0], *showtime);
         
         cout << "Showtime updated with limited changes!" << endl;
         return true;
@@ -249,6 +531,12 @@ bool ShowtimeService::updateShowtime(int showtimeId, const Showtime& updatedShow
         return false;
     }
     
+    if (!canTransition(showtime->getStatus(), updatedShowtime.getStatus())) {
+        cout << "Error: Cannot change showtime status from " << toString(showtime->getStatus()) 
+             << " to " << toString(updatedShowtime.getStatus()) << "!" << endl;
+        return false;
+    }
+    
     // Check for conflicts (excluding current showtime)
     if (checkTimeConflict(updatedShowtime.getAuditoriumId(), 
                          updatedShowtime.getStartTime(), 
@@ -258,60 +546,132 @@ bool ShowtimeService::updateShowtime(int showtimeId, const Showtime& updatedShow
         return false;
     }
     
+    size_t position = showtime - &showtimes[0];
+    unindexShowtime(position);
     *showtime = updatedShowtime;
     showtime->setId(showtimeId); // Preserve original ID
+    indexShowtime(position);
+    
+    if (showtimeListener) {
+        showtimeListener(*showtime);
+    }
     
     cout << "Showtime updated successfully!" << endl;
     return true;
 }
 
 bool ShowtimeService::cancelShowtime(int showtimeId, const string& reason) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     Showtime* showtime = findShowtimeById(showtimeId);
     if (!showtime) {
         cout << "Error: Showtime with ID " << showtimeId << " not found!" << endl;
         return false;
     }
     
+    if (!canTransition(showtime->getStatus(), ShowtimeStatus::CANCELED)) {
+        cout << "Error: Cannot cancel a " << toString(showtime->getStatus()) << " showtime!" << endl;
+        return false;
+    }
+    
     if (showtime->getSeatsAvailable() < showtime->getSeatsTotal()) {
         cout << "Warning: This showtime has sold tickets. Cancellation requires refund processing." << endl;
         cout << "Reason for cancellation: " << reason << endl;
     }
     
-    showtime->setStatus("canceled");
+    size_t position = showtime - &showtimes[0];
+    unindexShowtime(position);
+    showtime->setStatus(ShowtimeStatus::CANCELED);
+    indexShowtime(position); // Leaves the auditorium schedule, stays in the start time index
     
     cout << "Showtime canceled successfully!" << endl;
     return true;
 }
 
 Showtime* ShowtimeService::findShowtimeById(int showtimeId) {
-    for (auto& showtime : showtimes) {
-        if (showtime.getId() == showtimeId) {
-            return &showtime;
-        }
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    auto it = showtimePositions.find(showtimeId);
+    return it != showtimePositions.end() ? &showtimes[it->second] : nullptr;
+}
+
+const Showtime* ShowtimeService::findShowtimeById(int showtimeId) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    auto it = showtimePositions.find(showtimeId);
+    return it != showtimePositions.end() ? &showtimes[it->second] : nullptr;
+}
+
+bool ShowtimeService::updateSeatsAvailable(int showtimeId, int seatsAvailable) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    auto it = showtimePositions.find(showtimeId);
+    if (it == showtimePositions.end() || seatsAvailable < 0 || seatsAvailable > showtimes[it->second].getSeatsTotal()) {
+        return false;
     }
-    return nullptr;
+    
+    unrankShowtime(it->second);
+    showtimes[it->second].setSeatsAvailable(seatsAvailable);
+    columns.store(it->second, showtimes[it->second]);
+    rankShowtime(it->second);
+    return true;
 }
 
-vector<Showtime> ShowtimeService::searchShowtimes(const string& query) const {
+bool ShowtimeService::recordSeatSales(int showtimeId, int soldDelta) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    const Showtime* showtime = findShowtimeById(showtimeId);
+    if (!showtime) {
+        return false;
+    }
+    int seatsAvailable = showtime->getSeatsAvailable() - soldDelta;
+    seatsAvailable = max(0, min(seatsAvailable, showtime->getSeatsTotal()));
+    return updateSeatsAvailable(showtimeId, seatsAvailable);
+}
+
+vector<Showtime> ShowtimeService::searchShowtimes(const string& query, const atomic<bool>* canceled) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     vector<Showtime> results;
     
     // Try to parse as showtime ID
     try {
         int showtimeId = stoi(query);
-        for (const auto& showtime : showtimes) {
-            if (showtime.getId() == showtimeId) {
-                results.push_back(showtime);
-                return results;
-            }
+        const Showtime* showtime = findShowtimeById(showtimeId);
+        if (showtime) {
+            results.push_back(*showtime);
+            return results;
         }
     } catch (...) {
         // Not a number, continue with other search methods
     }
     
     // Search by format or status
+    if (columnarScans) {
+        vector<size_t> positions;
+        columns.search(query, positions);
+        for (size_t i = 0; i < positions.size() && !(canceled && *canceled); i++) {
+            results.push_back(showtimes[positions[i]]);
+        }
+        return results;
+    }
     for (const auto& showtime : showtimes) {
+        if (canceled && *canceled) {
+            break;
+        }
         if (showtime.getFormat().find(query) != string::npos ||
-            showtime.getStatus().find(query) != string::npos) {
+            string(toString(showtime.getStatus())).find(query) != string::npos) {
+            results.push_back(showtime);
+        }
+    }
+    
+    return results;
+}
+
+// Showtimes starting in [fromTime, toTime), in start time order: a binary search and a range scan
+vector<Showtime> ShowtimeService::getShowtimesInRange(time_t fromTime, time_t toTime, int status, 
+                                                      int auditoriumId) const {
+    vector<Showtime> results;
+    
+    auto it = startTimeIndex.lower_bound(make_pair(fromTime, INT_MIN));
+    for (; it != startTimeIndex.end() && it->first.first < toTime; ++it) {
+        const Showtime& showtime = showtimes[it->second];
+        if ((status < 0 || showtime.getStatus() == (ShowtimeStatus)status) &&
+            (auditoriumId <= 0 || showtime.getAuditoriumId() == auditoriumId)) {
             results.push_back(showtime);
         }
     }
@@ -321,12 +681,33 @@ vector<Showtime> ShowtimeService::searchShowtimes(const string& query) const {
 
 vector<Showtime> ShowtimeService::filterShowtimes(const string& status, int auditoriumId, 
                                                  time_t fromDate, time_t toDate) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     vector<Showtime> results;
+    int statusFilter;
+    if (!parseStatusFilter(status, statusFilter)) {
+        return results; // Unknown status
+    }
+    
+    // Date ranges come from the start time index, sorted by start time
+    if (fromDate > 0 || toDate > 0) {
+        time_t rangeEnd = toDate > 0 ? toDate + 1 : numeric_limits<time_t>::max(); // toDate is inclusive
+        return getShowtimesInRange(fromDate, rangeEnd, statusFilter, auditoriumId);
+    }
+    
+    if (columnarScans) {
+        vector<size_t> positions;
+        columns.filter(statusFilter, auditoriumId, numeric_limits<time_t>::min(), 
+                       numeric_limits<time_t>::max(), positions);
+        for (size_t position : positions) {
+            results.push_back(showtimes[position]);
+        }
+        return results;
+    }
     
     for (const auto& showtime : showtimes) {
         bool matches = true;
         
-        if (!status.empty() && showtime.getStatus() != status) {
+        if (statusFilter >= 0 && showtime.getStatus() != (ShowtimeStatus)statusFilter) {
             matches = false;
         }
         if (auditoriumId > 0 && showtime.getAuditoriumId() != auditoriumId) {
@@ -348,6 +729,7 @@ vector<Showtime> ShowtimeService::filterShowtimes(const string& status, int audi
 }
 
 bool ShowtimeService::bulkCreateShowtimes(const vector<Showtime>& showtimeList) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     int successCount = 0;
     for (const auto& showtime : showtimeList) {
         if (createShowtime(showtime)) {
@@ -361,91 +743,573 @@ bool ShowtimeService::bulkCreateShowtimes(const vector<Showtime>& showtimeList)
 }
 
 bool ShowtimeService::copySchedule(time_t fromDate, time_t toDate) {
-    vector<Showtime> sourceShowtimes = getShowtimesByDate(fromDate);
-    vector<Showtime> newShowtimes;
+    // Copy the whole day containing fromDate
+    LocalDay day = TimeService::getDay(fromDate);
     
-    time_t dateDiff = toDate - fromDate;
+    vector<ScheduleConflict> conflicts;
+    if (copyScheduleRange(day.start, day.end, TimeService::daysBetween(fromDate, toDate), conflicts)) {
+        return true;
+    }
     
-    for (const auto& showtime : sourceShowtimes) {
-        Showtime newShowtime = showtime;
-        newShowtime.setId(0); // Will be assigned new ID
-        newShowtime.setStartTime(showtime.getStartTime() + dateDiff);
-        newShowtime.setEndTime(showtime.getEndTime() + dateDiff);
-        newShowtime.setSeatsAvailable(showtime.getSeatsTotal()); // Reset availability
-        newShowtimes.push_back(newShowtime);
+    for (const auto& conflict : conflicts) {
+        cout << "Showtime " << conflict.source_showtime_id << " -> " << formatTime(conflict.start_time) 
+             << ": " << conflict.reason << endl;
+    }
+    return false;
+}
+
+bool ShowtimeService::copyScheduleRange(time_t fromTime, time_t toTime, int dayOffset, 
+                                        vector<ScheduleConflict>& conflicts) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    conflicts.clear();
+    time_t now = timeSource.now();
+    
+    // Source rows come out of the start time index already sorted, so grouping keeps each auditorium sorted
+    map<int, vector<Showtime>> copiesByAuditorium;
+    int rowCount = 0;
+    for (const auto& showtime : getShowtimesInRange(fromTime, toTime)) {
+        if (showtime.getStatus() == ShowtimeStatus::CANCELED) {
+            continue;
+        }
+        // A fresh showtime, so the copy is scheduled even when the source already ran
+        time_t startTime = TimeService::addDays(showtime.getStartTime(), dayOffset);
+        Showtime copy(showtime.getMovieVersionId(), showtime.getAuditoriumId(), 
+                      startTime, startTime + (showtime.getEndTime() - showtime.getStartTime()));
+        copy.setId(showtime.getId());
+        copy.setPriceTemplateId(showtime.getPriceTemplateId());
+        copy.setHoldTimeout(showtime.getHoldTimeout());
+        copy.setFormat(showtime.getFormat());
+        copy.setBasePrice(showtime.getBasePrice());
+        copiesByAuditorium[showtime.getAuditoriumId()].push_back(copy);
+        rowCount++;
     }
     
-    return bulkCreateShowtimes(newShowtimes);
+    for (const auto& group : copiesByAuditorium) {
+        const vector<Showtime>& copies = group.second;
+        Auditorium* auditorium = findAuditoriumById(group.first);
+        
+        // Existing showtimes that can reach the copied window, sorted by start time
+        vector<pair<pair<time_t, time_t>, int>> existing;
+        auto scheduleIt = schedules.find(group.first);
+        if (scheduleIt != schedules.end() && !copies.empty()) {
+            time_t windowStart = copies.front().getStartTime() - CLEANING_BUFFER_SECONDS - scheduleIt->second.getLongestSlot();
+            time_t windowEnd = 0;
+            for (const auto& copy : copies) {
+                windowEnd = max(windowEnd, copy.getEndTime() + CLEANING_BUFFER_SECONDS);
+            }
+            scheduleIt->second.getSlots(windowStart, windowEnd, existing);
+        }
+        time_t longestExisting = scheduleIt != schedules.end() ? scheduleIt->second.getLongestSlot() : 0;
+        
+        // One sweep: the first existing slot that can still overlap only moves forward
+        size_t first = 0;
+        time_t previousEnd = 0;
+        int previousId = 0;
+        for (const auto& copy : copies) {
+            ScheduleConflict conflict;
+            conflict.source_showtime_id = copy.getId();
+            conflict.start_time = copy.getStartTime();
+            conflict.conflicting_showtime_id = 0;
+            
+            if (!auditorium) {
+                conflict.reason = "Auditorium does not exist";
+            } else if (!copy.isValid()) {
+                conflict.reason = "Invalid showtime data";
+            } else if (!auditorium->supportsFormat(copy.getFormat())) {
+                conflict.reason = "Auditorium does not support format " + copy.getFormat();
+            } else if (copy.getStartTime() <= now) {
+                conflict.reason = "Start time is in the past";
+            }
+            if (!conflict.reason.empty()) {
+                conflicts.push_back(conflict);
+                continue;
+            }
+            
+            time_t bufferedStart = copy.getStartTime() - CLEANING_BUFFER_SECONDS;
+            time_t bufferedEnd = copy.getEndTime() + CLEANING_BUFFER_SECONDS;
+            
+            while (first < existing.size() && existing[first].first.first < bufferedStart - longestExisting) {
+                first++;
+            }
+            for (size_t k = first; k < existing.size() && existing[k].first.first < bufferedEnd; k++) {
+                if (existing[k].first.second > bufferedStart) {
+                    conflict.conflicting_showtime_id = existing[k].second;
+                    conflict.reason = "Time conflict with showtime " + to_string(existing[k].second);
+                    conflicts.push_back(conflict);
+                    break;
+                }
+            }
+            
+            // Copies of overlapping source rows would also overlap each other
+            if (conflict.reason.empty() && previousId != 0 && previousEnd > bufferedStart) {
+                conflict.reason = "Time conflict with copy of showtime " + to_string(previousId);
+                conflicts.push_back(conflict);
+            }
+            if (copy.getEndTime() > previousEnd) {
+                previousEnd = copy.getEndTime();
+                previousId = copy.getId();
+            }
+        }
+    }
+    
+    if (!conflicts.empty()) {
+        cout << "Error: Schedule copy rejected, " << conflicts.size() << "/" << rowCount 
+             << " showtimes conflict." << endl;
+        return false;
+    }
+    
+    // Commit every row at once
+    for (auto& group : copiesByAuditorium) {
+        commitShowtimes(group.second);
+    }
+    
+    cout << "Schedule copied: " << rowCount << " showtimes created." << endl;
+    return true;
+}
+
+// Adds showtimes that were already checked against the schedule
+void ShowtimeService::commitShowtimes(vector<Showtime>& newShowtimes) {
+    for (auto& showtime : newShowtimes) {
+        int capacity = findAuditoriumById(showtime.getAuditoriumId())->getCapacity();
+        showtime.setId(nextShowtimeId++);
+        showtime.setSeatsTotal(capacity);
+        showtime.setSeatsAvailable(capacity);
+        showtimes.push_back(showtime);
+        indexShowtime(showtimes.size() - 1);
+        
+        if (showtimeListener) {
+            showtimeListener(showtime);
+        }
+    }
+}
+
+// ShowtimePacker - fills auditorium timelines with shows of the demanded movie versions
+// A room's shows are always re-laid out from its item list, so moves only edit lists
+class ShowtimePacker {
+public:
+    struct Room {
+        int auditorium_id;
+        vector<pair<time_t, time_t>> blocked; // Existing showtimes widened by the buffer, sorted
+        vector<int> items; // Demand indexes
+        vector<time_t> starts; // Start of each item after the last successful layout
+    };
+
+private:
+    time_t open_time;
+    time_t close_time;
+    time_t buffer;
+    vector<time_t> lengths; // Runtime in seconds per demand
+    vector<int> targets;
+    vector<vector<int>> eligible_rooms; // Per demand
+    vector<Room> rooms;
+    vector<int> placed;
+    
+    static const time_t GRID = 5 * 60; // Start times fall on 5-minute marks
+    
+    time_t alignUp(time_t t) const {
+        time_t offset = (t - open_time) % GRID;
+        return offset == 0 ? t : t + GRID - offset;
+    }
+    
+    // Lays items out back to back (longest first) around blocked intervals; false if they do not fit
+    bool layout(const vector<int>& items, const vector<pair<time_t, time_t>>& blocked, 
+                vector<int>& order, vector<time_t>& starts) const {
+        order = items;
+        stable_sort(order.begin(), order.end(), [this](int a, int b) { return lengths[a] > lengths[b]; });
+        starts.assign(order.size(), 0);
+        
+        time_t cursor = open_time;
+        size_t next = 0; // First blocked interval that may still matter
+        for (size_t i = 0; i < order.size(); i++) {
+            time_t start = alignUp(cursor);
+            time_t length = lengths[order[i]];
+            while (next < blocked.size() && blocked[next].second <= start) {
+                next++;
+            }
+            // Skip past every blocked interval the show would run into
+            for (size_t k = next; k < blocked.size() && blocked[k].first < start + length; k++) {
+                if (blocked[k].second > start) {
+                    start = alignUp(blocked[k].second);
+                }
+            }
+            if (start + length > close_time) {
+                return false;
+            }
+            starts[i] = start;
+            cursor = start + length + buffer;
+        }
+        return true;
+    }
+    
+    bool relayout(Room& room, const vector<int>& items) const {
+        vector<int> order;
+        vector<time_t> starts;
+        if (!layout(items, room.blocked, order, starts)) {
+            return false;
+        }
+        room.items = order;
+        room.starts = starts;
+        return true;
+    }
+    
+    // Higher is better: shows placed, then even fulfilment across demands, then busy screen time
+    void score(const vector<int>& counts, long long& shows, double& balance, long long& busy) const {
+        shows = 0;
+        balance = 0.0;
+        busy = 0;
+        for (size_t d = 0; d < counts.size(); d++) {
+            shows += counts[d];
+            double deficit = targets[d] > 0 ? (double)(targets[d] - counts[d]) / targets[d] : 0.0;
+            balance -= deficit * deficit;
+            busy += counts[d] * lengths[d];
+        }
+    }
+    
+    bool better(const vector<int>& candidate, const vector<int>& current) const {
+        long long shows1, busy1, shows2, busy2;
+        double balance1, balance2;
+        score(candidate, shows1, balance1, busy1);
+        score(current, shows2, balance2, busy2);
+        if (shows1 != shows2) return shows1 > shows2;
+        if (balance1 > balance2 + 1e-9) return true;
+        if (balance1 < balance2 - 1e-9) return false;
+        return busy1 > busy2;
+    }
+    
+    // Most under-served demand that may still go into the room, or -1
+    int neediestFor(int roomIndex, const vector<int>& counts, const vector<int>& skip) const {
+        int best = -1;
+        double bestDeficit = 0.0;
+        for (size_t d = 0; d < counts.size(); d++) {
+            if (counts[d] >= targets[d] || find(skip.begin(), skip.end(), (int)d) != skip.end() ||
+                find(eligible_rooms[d].begin(), eligible_rooms[d].end(), roomIndex) == eligible_rooms[d].end()) {
+                continue;
+            }
+            double deficit = (double)(targets[d] - counts[d]) / targets[d];
+            if (best < 0 || deficit > bestDeficit || (deficit == bestDeficit && lengths[d] < lengths[best])) {
+                best = (int)d;
+                bestDeficit = deficit;
+            }
+        }
+        return best;
+    }
+    
+    // Adds under-served demands to a room's item list while they still fit
+    void fill(int roomIndex, vector<int>& items, vector<int>& counts) const {
+        vector<int> full;
+        vector<int> order;
+        vector<time_t> starts;
+        for (;;) {
+            int d = neediestFor(roomIndex, counts, full);
+            if (d < 0) {
+                return;
+            }
+            items.push_back(d);
+            if (layout(items, rooms[roomIndex].blocked, order, starts)) {
+                counts[d]++;
+            } else {
+                items.pop_back();
+                full.push_back(d);
+            }
+        }
+    }
+
+public:
+    ShowtimePacker(time_t openTime, time_t closeTime, time_t bufferSeconds)
+        : open_time(openTime), close_time(closeTime), buffer(bufferSeconds) {}
+    
+    int addRoom(int auditoriumId, const vector<pair<time_t, time_t>>& blocked) {
+        Room room;
+        room.auditorium_id = auditoriumId;
+        room.blocked = blocked;
+        sort(room.blocked.begin(), room.blocked.end());
+        rooms.push_back(room);
+        return rooms.size() - 1;
+    }
+    
+    void addDemand(time_t lengthSeconds, int targetShows, const vector<int>& roomIndexes) {
+        lengths.push_back(lengthSeconds);
+        targets.push_back(targetShows);
+        eligible_rooms.push_back(roomIndexes);
+        placed.push_back(0);
+    }
+    
+    const vector<Room>& getRooms() const { return rooms; }
+    const vector<int>& getPlacedCounts() const { return placed; }
+    
+    // Greedy: the most under-served demand goes to its least busy room that can take it
+    void placeGreedy() {
+        vector<bool> stuck(targets.size(), false);
+        for (;;) {
+            int d = -1;
+            double bestDeficit = 0.0;
+            for (size_t i = 0; i < targets.size(); i++) {
+                if (stuck[i] || placed[i] >= targets[i]) {
+                    continue;
+                }
+                double deficit = (double)(targets[i] - placed[i]) / targets[i];
+                // Ties go to demands with fewer rooms, then longer runtimes: they are hardest to place
+                if (d < 0 || deficit > bestDeficit ||
+                    (deficit == bestDeficit && (eligible_rooms[i].size() < eligible_rooms[d].size() ||
+                     (eligible_rooms[i].size() == eligible_rooms[d].size() && lengths[i] > lengths[d])))) {
+                    d = (int)i;
+                    bestDeficit = deficit;
+                }
+            }
+            if (d < 0) {
+                return;
+            }
+            
+            vector<int> candidates = eligible_rooms[d];
+            stable_sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+                time_t busyA = 0, busyB = 0;
+                for (int item : rooms[a].items) busyA += lengths[item];
+                for (int item : rooms[b].items) busyB += lengths[item];
+                return busyA < busyB;
+            });
+            
+            bool done = false;
+            for (int r : candidates) {
+                vector<int> items = rooms[r].items;
+                items.push_back(d);
+                if (relayout(rooms[r], items)) {
+                    placed[d]++;
+                    done = true;
+                    break;
+                }
+            }
+            stuck[d] = !done;
+        }
+    }
+    
+    // Local search: swap one show in a room for under-served ones, or move it to another room,
+    // then refill the room; keep a change only if the score improves
+    void improve(int maxRounds) {
+        for (int round = 0; round < maxRounds; round++) {
+            bool improved = false;
+            for (size_t r = 0; r < rooms.size(); r++) {
+                for (size_t i = 0; i < rooms[r].items.size() && !improved; i++) {
+                    int removed = rooms[r].items[i];
+                    
+                    // Swap: drop the show, refill the room with under-served demands
+                    vector<int> items = rooms[r].items;
+                    items.erase(items.begin() + i);
+                    vector<int> counts = placed;
+                    counts[removed]--;
+                    fill((int)r, items, counts);
+                    if (better(counts, placed) && relayout(rooms[r], items)) {
+                        placed = counts;
+                        improved = true;
+                        break;
+                    }
+                    
+                    // Move: put the show into another eligible room, then refill this one
+                    for (int other : eligible_rooms[removed]) {
+                        if (other == (int)r) {
+                            continue;
+                        }
+                        vector<int> otherItems = rooms[other].items;
+                        otherItems.push_back(removed);
+                        vector<int> order;
+                        vector<time_t> starts;
+                        if (!layout(otherItems, rooms[other].blocked, order, starts)) {
+                            continue;
+                        }
+                        vector<int> roomItems = rooms[r].items;
+                        roomItems.erase(roomItems.begin() + i);
+                        vector<int> moveCounts = placed;
+                        fill((int)r, roomItems, moveCounts);
+                        if (better(moveCounts, placed) && relayout(rooms[r], roomItems)) {
+                            relayout(rooms[other], otherItems);
+                            placed = moveCounts;
+                            improved = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (!improved) {
+                return;
+            }
+        }
+    }
+};
+
+vector<Showtime> ShowtimeService::planSchedule(const vector<ShowtimeDemand>& demands, time_t openTime, 
+                                               time_t closeTime, vector<int>& placedCounts) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    // Shows cannot start in the past
+    time_t now = timeSource.now();
+    if (openTime <= now) {
+        openTime = now + 60 - now % 60;
+    }
+    
+    ShowtimePacker packer(openTime, closeTime, CLEANING_BUFFER_SECONDS);
+    map<int, int> roomIndexes; // auditorium_id -> packer room
+    for (const auto& auditorium : auditoriums) {
+        // Existing showtimes block their slot plus the buffer on both sides
+        vector<pair<pair<time_t, time_t>, int>> slots;
+        auto it = schedules.find(auditorium.getId());
+        if (it != schedules.end()) {
+            it->second.getSlots(openTime - CLEANING_BUFFER_SECONDS - it->second.getLongestSlot(), 
+                                closeTime + CLEANING_BUFFER_SECONDS, slots);
+        }
+        vector<pair<time_t, time_t>> blocked;
+        for (const auto& slot : slots) {
+            blocked.push_back(make_pair(slot.first.first - CLEANING_BUFFER_SECONDS, 
+                                        slot.first.second + CLEANING_BUFFER_SECONDS));
+        }
+        roomIndexes[auditorium.getId()] = packer.addRoom(auditorium.getId(), blocked);
+    }
+    
+    for (const auto& demand : demands) {
+        vector<int> eligible;
+        for (const auto& auditorium : auditoriums) {
+            if (auditorium.supportsFormat(demand.version.getType()) &&
+                (demand.room_type.empty() || auditorium.getRoomType() == demand.room_type)) {
+                eligible.push_back(roomIndexes[auditorium.getId()]);
+            }
+        }
+        int runtime = demand.version.getRuntime() > 0 ? demand.version.getRuntime() : 0;
+        packer.addDemand((time_t)runtime * 60, runtime > 0 ? max(demand.target_shows, 0) : 0, eligible);
+    }
+    
+    packer.placeGreedy();
+    packer.improve(50);
+    placedCounts = packer.getPlacedCounts();
+    
+    vector<Showtime> plan;
+    for (const auto& room : packer.getRooms()) {
+        for (size_t i = 0; i < room.items.size(); i++) {
+            const ShowtimeDemand& demand = demands[room.items[i]];
+            time_t start = room.starts[i];
+            Showtime showtime(demand.version.getId(), room.auditorium_id, start, 
+                              start + (time_t)demand.version.getRuntime() * 60);
+            showtime.setFormat(demand.version.getType());
+            showtime.setBasePrice(demand.base_price);
+            plan.push_back(showtime);
+        }
+    }
+    sort(plan.begin(), plan.end(), [](const Showtime& a, const Showtime& b) {
+        return a.getStartTime() < b.getStartTime() || 
+               (a.getStartTime() == b.getStartTime() && a.getAuditoriumId() < b.getAuditoriumId());
+    });
+    return plan;
+}
+
+bool ShowtimeService::autoSchedule(const vector<ShowtimeDemand>& demands, time_t openTime, time_t closeTime) {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    vector<int> placedCounts;
+    vector<Showtime> plan = planSchedule(demands, openTime, closeTime, placedCounts);
+    
+    // The plan is conflict-free against existing showtimes and itself, so it is committed as is
+    commitShowtimes(plan);
+    
+    int targetTotal = 0;
+    for (size_t d = 0; d < demands.size(); d++) {
+        targetTotal += max(demands[d].target_shows, 0);
+        if (placedCounts[d] < demands[d].target_shows) {
+            cout << "Movie version " << demands[d].version.getId() << ": " << placedCounts[d] << "/" 
+                 << demands[d].target_shows << " shows placed" << endl;
+        }
+    }
+    cout << "Auto schedule created " << plan.size() << "/" << targetTotal << " showtimes." << endl;
+    return !plan.empty();
 }
 
 bool ShowtimeService::hasConflict(int auditoriumId, time_t startTime, time_t endTime) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     return checkTimeConflict(auditoriumId, startTime, endTime);
 }
 
 vector<Showtime> ShowtimeService::getConflictingShowtimes(int auditoriumId, time_t startTime, time_t endTime) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     vector<Showtime> conflicts;
     
-    for (const auto& showtime : showtimes) {
-        if (showtime.getAuditoriumId() == auditoriumId && 
-            showtime.getStatus() != "canceled") {
-            
-            if ((startTime >= showtime.getStartTime() && startTime < showtime.getEndTime()) ||
-                (endTime > showtime.getStartTime() && endTime <= showtime.getEndTime()) ||
-                (startTime <= showtime.getStartTime() && endTime >= showtime.getEndTime())) {
-                conflicts.push_back(showtime);
-            }
+    auto it = schedules.find(auditoriumId);
+    if (it != schedules.end()) {
+        for (size_t position : it->second.findOverlapping(startTime - CLEANING_BUFFER_SECONDS, 
+                                                          endTime + CLEANING_BUFFER_SECONDS)) {
+            conflicts.push_back(showtimes[position]);
         }
     }
     
     return conflicts;
 }
 
-vector<Showtime> ShowtimeService::getShowtimesByDate(time_t date) const {
-    vector<Showtime> results;
-    
+vector<Showtime> ShowtimeService::getShowtimesByDate(time_t date, const string& status, int auditoriumId) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     // Get start and end of the day
-    struct tm* dateInfo = localtime(&date);
-    dateInfo->tm_hour = 0;
-    dateInfo->tm_min = 0;
-    dateInfo->tm_sec = 0;
-    time_t dayStart = mktime(dateInfo);
-    time_t dayEnd = dayStart + 24 * 3600;
+    LocalDay day = TimeService::getDay(date);
     
-    for (const auto& showtime : showtimes) {
-        if (showtime.getStartTime() >= dayStart && showtime.getStartTime() < dayEnd) {
-            results.push_back(showtime);
-        }
+    int statusFilter;
+    if (!parseStatusFilter(status, statusFilter)) {
+        return vector<Showtime>(); // Unknown status
     }
-    
-    return results;
+    return getShowtimesInRange(day.start, day.end, statusFilter, auditoriumId);
 }
 
 vector<Showtime> ShowtimeService::getShowtimesByAuditorium(int auditoriumId) const {
     return filterShowtimes("", auditoriumId);
 }
 
+OccupancyStats ShowtimeService::getOccupancyStats() const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    return occupancyTotals;
+}
+
 double ShowtimeService::getAverageOccupancyRate() const {
-    if (showtimes.empty()) return 0.0;
-    
-    double totalOccupancy = 0.0;
-    for (const auto& showtime : showtimes) {
-        totalOccupancy += showtime.getOccupancyRate();
-    }
-    
-    return totalOccupancy / showtimes.size();
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    return occupancyTotals.getAverageRate();
+}
+
+OccupancyStats ShowtimeService::getAuditoriumOccupancy(int auditoriumId) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    auto it = auditoriumOccupancy.find(auditoriumId);
+    return it != auditoriumOccupancy.end() ? it->second : OccupancyStats();
+}
+
+OccupancyStats ShowtimeService::getDailyOccupancy(time_t date) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    auto it = dailyOccupancy.find(TimeService::dayStart(date));
+    return it != dailyOccupancy.end() ? it->second : OccupancyStats();
 }
 
 vector<Showtime> ShowtimeService::getTopPerformingShowtimes(int limit) const {
-    vector<Showtime> sortedShowtimes = heapSortShowtimes(showtimes, false); // Sort by occupancy
-    
-    if (sortedShowtimes.size() > static_cast<size_t>(limit)) {
-        sortedShowtimes.resize(limit);
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    vector<Showtime> topShowtimes;
+    for (auto it = occupancyRanking.begin(); it != occupancyRanking.end() && (int)topShowtimes.size() < limit; ++it) {
+        topShowtimes.push_back(showtimes[showtimePositions.at(it->second)]);
+    }
+    return topShowtimes;
+}
+
+vector<Showtime> ShowtimeService::getUpcomingShowtimes(const vector<int>& movieVersionIds, time_t fromTime, 
+                                                      size_t limit) const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
+    // Up to limit from each version, then the earliest of those
+    vector<pair<time_t, int>> upcoming;
+    for (int versionId : movieVersionIds) {
+        auto found = versionStartIndex.find(versionId);
+        if (found == versionStartIndex.end()) {
+            continue;
+        }
+        auto it = found->second.lower_bound(make_pair(fromTime, INT_MIN));
+        for (size_t taken = 0; it != found->second.end() && taken < limit; ++it, ++taken) {
+            upcoming.push_back(*it);
+        }
     }
+    sort(upcoming.begin(), upcoming.end());
     
-    return sortedShowtimes;
+    vector<Showtime> result;
+    for (size_t i = 0; i < upcoming.size() && i < limit; i++) {
+        result.push_back(showtimes[showtimePositions.at(upcoming[i].second)]);
+    }
+    return result;
 }
 
 void ShowtimeService::displayAllShowtimes() const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     cout << "\n=== ALL SHOWTIMES ===" << endl;
     for (const auto& showtime : showtimes) {
         showtime.displayInfo();
@@ -454,6 +1318,7 @@ void ShowtimeService::displayAllShowtimes() const {
 }
 
 void ShowtimeService::displayAllAuditoriums() const {
+    lock_guard<recursive_mutex> guard(showtimesMutex);
     cout << "\n=== ALL AUDITORIUMS ===" << endl;
     for (const auto& auditorium : auditoriums) {
         auditorium.displayInfo();
@@ -461,14 +1326,12 @@ void ShowtimeService::displayAllAuditoriums() const {
 }
 
 string ShowtimeService::formatTime(time_t timeValue) const {
-    char buffer[80];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", localtime(&timeValue));
-    return string(buffer);
+    return TimeService::formatDateTime(timeValue);
 }
 
 time_t ShowtimeService::parseTime(const string& timeStr) const {
     // Simple time parsing - in real implementation would use proper parsing
-    return time(0) + 3600; // Return 1 hour from now as placeholder
+    return timeSource.now() + 3600; // Return 1 hour from now as placeholder
 }
 
 // Demo functions
@@ -493,7 +1356,7 @@ void ShowtimeService::createShowtimeDemo() {
     cin >> price;
     
     // Create showtime for tomorrow
-    time_t tomorrow = time(0) + 24 * 3600;
+    time_t tomorrow = timeSource.now() + 24 * 3600;
     time_t endTime = tomorrow + 2 * 3600; // 2 hours duration
     
     Showtime newShowtime(movieVersionId, auditoriumId, tomorrow, endTime);
@@ -569,7 +1432,7 @@ void ShowtimeService::bulkCreateDemo() {
     cout << "\n=== BULK CREATE DEMO ===" << endl;
     
     vector<Showtime> bulkShowtimes;
-    time_t baseTime = time(0) + 24 * 3600; // Tomorrow
+    time_t baseTime = timeSource.now() + 24 * 3600; // Tomorrow
     
     // Create 3 sample showtimes
     for (int i = 0; i < 3; i++) {
@@ -589,15 +1452,161 @@ void ShowtimeService::bulkCreateDemo() {
 void ShowtimeService::copyScheduleDemo() {
     cout << "\n=== COPY SCHEDULE DEMO ===" << endl;
     
-    time_t today = time(0);
-    time_t tomorrow = today + 24 * 3600;
-    time_t dayAfterTomorrow = today + 48 * 3600;
+    time_t weekStart = TimeService::getDay(timeSource.now()).end; // Tomorrow
+    
+    cout << "Copying the week starting tomorrow to the following week..." << endl;
     
-    cout << "Copying schedule from tomorrow to day after tomorrow..." << endl;
+    vector<ScheduleConflict> conflicts;
+    clock_t start = clock();
+    bool copied = copyScheduleRange(weekStart, TimeService::addDays(weekStart, 7), 7, conflicts);
+    double elapsedMs = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
     
-    if (copySchedule(tomorrow, dayAfterTomorrow)) {
-        cout << "Schedule copied successfully!" << endl;
+    if (copied) {
+        cout << "Schedule copied successfully in " << fixed << setprecision(3) << elapsedMs << " ms!" << endl;
     } else {
+        for (const auto& conflict : conflicts) {
+            cout << "Showtime " << conflict.source_showtime_id << " -> " << formatTime(conflict.start_time) 
+                 << ": " << conflict.reason << endl;
+        }
         cout << "Failed to copy schedule!" << endl;
     }
 }
+
+// Sample demands: a day of tomorrow's releases across the sample auditoriums
+void ShowtimeService::autoScheduleDemo() {
+    cout << "\n=== AUTO SCHEDULE DEMO ===" << endl;
+    
+    time_t openTime = TimeService::getDay(timeSource.now()).end + 9 * 3600; // Tomorrow
+    time_t closeTime = openTime + 15 * 3600; // 09:00 - 24:00
+    
+    vector<ShowtimeDemand> demands;
+    const char* types[] = {"2D", "3D", "IMAX", "4DX", "2D"};
+    const int runtimes[] = {148, 169, 152, 115, 96};
+    const int targets[] = {4, 3, 3, 4, 5};
+    for (int i = 0; i < 5; i++) {
+        MovieVersion version(i + 1, types[i], runtimes[i]);
+        version.setId(i + 1);
+        demands.push_back(ShowtimeDemand(version, targets[i], 10.0 + 2.0 * i));
+    }
+    
+    autoSchedule(demands, openTime, closeTime);
+    for (const auto& showtime : getShowtimesInRange(openTime, closeTime, (int)ShowtimeStatus::SCHEDULED)) {
+        cout << formatTime(showtime.getStartTime()) << " - " << formatTime(showtime.getEndTime()) 
+             << " | Auditorium " << showtime.getAuditoriumId() << " | Version " 
+             << showtime.getMovieVersionId() << " (" << showtime.getFormat() << ")" << endl;
+    }
+}
+
+// Benchmark: solve time of planSchedule against the number of screens and films
+void ShowtimeService::schedulerBenchmarkDemo() {
+    cout << "\n=== SCHEDULER BENCHMARK ===" << endl;
+    cout << setw(8) << "Screens" << setw(8) << "Films" << setw(10) << "Shows" 
+         << setw(10) << "Target" << setw(12) << "Time (ms)" << endl;
+    
+    time_t openTime = timeSource.now() + 2 * 24 * 3600;
+    openTime -= openTime % 3600;
+    time_t closeTime = openTime + 15 * 3600;
+    const char* roomTypes[] = {"Standard", "Standard", "IMAX", "Standard", "4DX"};
+    const char* versionTypes[] = {"2D", "3D", "2D", "IMAX", "2D", "4DX", "3D"};
+    
+    const int sizes[][2] = {{4, 4}, {8, 8}, {16, 12}, {24, 20}, {32, 30}, {48, 40}};
+    for (const auto& size : sizes) {
+        ShowtimeService bench;
+        bench.auditoriums.clear();
+        bench.schedules.clear();
+        bench.startTimeIndex.clear();
+        bench.showtimes.clear();
+        for (int a = 0; a < size[0]; a++) {
+            Auditorium auditorium(a + 1, "Screen " + to_string(a + 1), 120);
+            auditorium.setRoomType(roomTypes[a % 5]);
+            if (a % 5 == 2) {
+                auditorium.setFormatSupport({"2D", "3D", "IMAX"});
+            } else if (a % 5 == 4) {
+                auditorium.setFormatSupport({"2D", "3D", "4DX"});
+            }
+            bench.auditoriums.push_back(auditorium);
+        }
+        
+        vector<ShowtimeDemand> demands;
+        int targetTotal = 0;
+        for (int f = 0; f < size[1]; f++) {
+            MovieVersion version(f + 1, versionTypes[f % 7], 90 + (f * 37) % 80);
+            version.setId(f + 1);
+            int target = 1 + (size[0] * 5) / size[1] + f % 3; // Slightly more shows than fit
+            demands.push_back(ShowtimeDemand(version, target));
+            targetTotal += target;
+        }
+        
+        vector<int> placedCounts;
+        clock_t start = clock();
+        vector<Showtime> plan = bench.planSchedule(demands, openTime, closeTime, placedCounts);
+        double elapsedMs = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+        
+        cout << setw(8) << size[0] << setw(8) << size[1] << setw(10) << plan.size() 
+             << setw(10) << targetTotal << setw(12) << fixed << setprecision(2) << elapsedMs << endl;
+    }
+}
+
+void ShowtimeService::columnarScanBenchmarkDemo() {
+    cout << "\n=== COLUMNAR SCAN BENCHMARK ===" << endl;
+    const int showtimeCount = 120000;
+    const int auditoriumCount = 20;
+    const int repeats = 20;
+    const char* formats[] = {"2D", "3D", "IMAX", "4DX"};
+    
+    ShowtimeService bench;
+    time_t start = timeSource.now() + 24 * 3600;
+    start -= start % 3600;
+    for (int i = 0; i < showtimeCount; i++) {
+        time_t startTime = start + (time_t)(i / auditoriumCount) * 3 * 3600;
+        Showtime showtime(1 + i % 50, 1 + i % auditoriumCount, startTime, startTime + 2 * 3600);
+        showtime.setId(bench.nextShowtimeId++);
+        showtime.setFormat(formats[(i / 7) % 4]);
+        showtime.setSeatsTotal(120);
+        showtime.setSeatsAvailable(120 - i % 121);
+        if (i % 20 == 0) {
+            showtime.setStatus(ShowtimeStatus::CANCELED);
+        } else if (i % 7 == 0) {
+            showtime.setStatus(ShowtimeStatus::COMPLETED);
+        }
+        bench.showtimes.push_back(showtime);
+        bench.indexShowtime(bench.showtimes.size() - 1);
+    }
+    cout << bench.showtimes.size() << " showtimes, " << repeats << " runs per query" << endl;
+    cout << setw(30) << "Query" << setw(10) << "Rows" << setw(14) << "Objects (ms)" 
+         << setw(14) << "Columns (ms)" << setw(10) << "Speedup" << endl;
+    
+    for (int query = 0; query < 4; query++) {
+        string label;
+        double elapsedMs[2];
+        size_t rows[2];
+        for (int columnar = 0; columnar < 2; columnar++) {
+            bench.setColumnarScans(columnar == 1);
+            clock_t begin = clock();
+            for (int r = 0; r < repeats; r++) {
+                if (query == 0) {
+                    label = "status=scheduled, screen 7";
+                    rows[columnar] = bench.filterShowtimes("scheduled", 7).size();
+                } else if (query == 1) {
+                    label = "status=canceled";
+                    rows[columnar] = bench.filterShowtimes("canceled").size();
+                } else if (query == 2) {
+                    label = "screen 3";
+                    rows[columnar] = bench.getShowtimesByAuditorium(3).size();
+                } else {
+                    label = "search \"IMAX\"";
+                    rows[columnar] = bench.searchShowtimes("IMAX").size();
+                }
+            }
+            elapsedMs[columnar] = (double)(clock() - begin) * 1000.0 / CLOCKS_PER_SEC / repeats;
+        }
+        
+        cout << setw(30) << label << setw(10) << rows[1] << setw(14) << fixed << setprecision(3) 
+             << elapsedMs[0] << setw(14) << elapsedMs[1] << setw(9) << setprecision(1) 
+             << (elapsedMs[1] > 0 ? elapsedMs[0] / elapsedMs[1] : 0.0) << "x";
+        if (rows[0] != rows[1]) {
+            cout << "  (mismatch: " << rows[0] << " rows from objects)";
+        }
+        cout << endl;
+    }
+}
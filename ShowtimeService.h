@@ -5,9 +5,24 @@
 #include <vector>
 #include <ctime>
 #include <iostream>
+#include <functional>
+#include <map>
+#include <set>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include "MovieService.h"
 
 using namespace std;
 
+// Showtime status: scheduled -> canceled or completed (both final)
+enum class ShowtimeStatus : uint8_t { SCHEDULED, CANCELED, COMPLETED };
+
+const char* toString(ShowtimeStatus status);
+bool parseStatus(const string& text, ShowtimeStatus& status); // Case-insensitive
+bool canTransition(ShowtimeStatus from, ShowtimeStatus to);
+
 // Auditorium class
 class Auditorium {
 private:
@@ -53,7 +68,7 @@ private:
     int price_template_id;
     int seats_total;
     int seats_available;
-    string status; // scheduled, canceled, completed
+    ShowtimeStatus status;
     int hold_timeout_seconds;
     string format; // 2D, 3D, IMAX, etc.
     double base_price;
@@ -71,7 +86,7 @@ public:
     int getPriceTemplateId() const { return price_template_id; }
     int getSeatsTotal() const { return seats_total; }
     int getSeatsAvailable() const { return seats_available; }
-    string getStatus() const { return status; }
+    ShowtimeStatus getStatus() const { return status; }
     int getHoldTimeout() const { return hold_timeout_seconds; }
     string getFormat() const { return format; }
     double getBasePrice() const { return base_price; }
@@ -85,7 +100,7 @@ public:
     void setPriceTemplateId(int newPriceTemplateId) { price_template_id = newPriceTemplateId; }
     void setSeatsTotal(int newSeatsTotal) { seats_total = newSeatsTotal; }
     void setSeatsAvailable(int newSeatsAvailable) { seats_available = newSeatsAvailable; }
-    void setStatus(const string& newStatus) { status = newStatus; }
+    bool setStatus(ShowtimeStatus newStatus); // False if the transition is not allowed
     void setHoldTimeout(int newTimeout) { hold_timeout_seconds = newTimeout; }
     void setFormat(const string& newFormat) { format = newFormat; }
     void setBasePrice(double newPrice) { base_price = newPrice; }
@@ -95,20 +110,148 @@ public:
     double getOccupancyRate() const;
 };
 
+// AuditoriumSchedule class - one auditorium's active showtimes ordered by start time
+// Overlap queries only look at slots starting within the longest slot before the query,
+// so they cost O(log n + k) for schedules of movie-length showtimes
+class AuditoriumSchedule {
+private:
+    map<pair<time_t, int>, pair<time_t, size_t>> slots; // (start_time, showtime_id) -> (end_time, position)
+    multiset<time_t> durations; // Of every slot, so the longest is known again after it is removed
+
+public:
+    
+    void add(int showtimeId, time_t startTime, time_t endTime, size_t position);
+    void remove(int showtimeId, time_t startTime);
+    int getSlotCount() const { return slots.size(); }
+    time_t getLongestSlot() const { return durations.empty() ? 0 : *durations.rbegin(); }
+    
+    // Slots starting in [fromTime, toTime) as (start_time, end_time, showtime_id), in start order
+    void getSlots(time_t fromTime, time_t toTime, vector<pair<pair<time_t, time_t>, int>>& result) const;
+    
+    // Positions of slots overlapping [startTime, endTime), in start order
+    vector<size_t> findOverlapping(time_t startTime, time_t endTime, int excludeShowtimeId = -1) const;
+    bool overlaps(time_t startTime, time_t endTime, int excludeShowtimeId = -1) const;
+};
+
+// ShowtimeColumns class - showtime fields used by scans, one contiguous array per field
+// Format is dictionary coded, so a filter compares small integers instead of strings.
+// Rows are showtime positions in ShowtimeService.
+class ShowtimeColumns {
+private:
+    vector<time_t> start_times;
+    vector<time_t> end_times;
+    vector<int> auditorium_ids;
+    vector<int> movie_version_ids;
+    vector<ShowtimeStatus> statuses;
+    vector<uint16_t> format_codes;
+    vector<int> seats_total;
+    vector<int> seats_available;
+    vector<string> format_names; // Code -> format
+    
+    static uint16_t encode(vector<string>& names, const string& value);
+
+public:
+    size_t size() const { return start_times.size(); }
+    void store(size_t position, const Showtime& showtime); // Appends or overwrites a row
+    
+    // Rows matching every filter: status < 0 (else a ShowtimeStatus) and auditoriumId <= 0 match all,
+    // start times are inclusive
+    void filter(int status, int auditoriumId, time_t fromTime, time_t toTime, vector<size_t>& positions) const;
+    // Rows whose status or format contains text
+    void search(const string& text, vector<size_t>& positions) const;
+};
+
+// ScheduleConflict struct - why one row of a schedule copy cannot be created
+struct ScheduleConflict {
+    int source_showtime_id;
+    time_t start_time; // Start time the copy would have had
+    int conflicting_showtime_id; // 0 when the row itself is invalid
+    string reason;
+};
+
+// ShowtimeDemand struct - a movie version the scheduler should place and how often
+struct ShowtimeDemand {
+    MovieVersion version; // Id, runtime in minutes and type (2D, 3D, IMAX, 4DX) as the showtime format
+    int target_shows;
+    string room_type; // Required auditorium room type, empty for any
+    double base_price;
+    
+    ShowtimeDemand() : target_shows(0), base_price(10.0) {}
+    ShowtimeDemand(const MovieVersion& movieVersion, int targetShows, double basePrice = 10.0)
+        : version(movieVersion), target_shows(targetShows), base_price(basePrice) {}
+};
+
+// OccupancyStats struct - running seat and occupancy totals over a group of showtimes
+struct OccupancyStats {
+    int showtime_count;
+    long seats_total;
+    long seats_sold;
+    double rate_sum; // Sum of the showtimes' occupancy rates
+    
+    OccupancyStats() : showtime_count(0), seats_total(0), seats_sold(0), rate_sum(0.0) {}
+    
+    void add(int seatsTotal, int seatsSold, double rate);
+    void remove(int seatsTotal, int seatsSold, double rate);
+    double getAverageRate() const { return showtime_count > 0 ? rate_sum / showtime_count : 0.0; }
+    double getSeatOccupancyRate() const { return seats_total > 0 ? (double)seats_sold / seats_total * 100.0 : 0.0; }
+};
+
+// OccupancyEntry struct - what a showtime was counted under, so it can be taken back out
+struct OccupancyEntry {
+    double rate;
+    int seats_total;
+    int seats_sold;
+    int auditorium_id;
+    time_t day_start; // Local midnight of the start time
+};
+
 // ShowtimeService class - Business Logic Layer
 class ShowtimeService {
 private:
     vector<Showtime> showtimes;
     vector<Auditorium> auditoriums;
+    map<int, AuditoriumSchedule> schedules; // auditorium_id -> showtimes that are not canceled
+    map<pair<time_t, int>, size_t> startTimeIndex; // (start_time, showtime_id) -> position, all showtimes
+    unordered_map<int, size_t> showtimePositions; // showtime_id -> position
+    unordered_map<int, set<pair<time_t, int>>> versionStartIndex; // movie_version_id -> (start_time, showtime_id), not canceled
+    set<pair<double, int>> occupancyRanking; // (-occupancy rate, showtime_id): best first
+    vector<OccupancyEntry> occupancyEntries; // What each showtime is ranked and counted under, by position
+    OccupancyStats occupancyTotals; // All showtimes
+    unordered_map<int, OccupancyStats> auditoriumOccupancy; // auditorium_id -> its showtimes
+    map<time_t, OccupancyStats> dailyOccupancy; // Local midnight -> showtimes starting that day
+    ShowtimeColumns columns; // Columnar copy of showtimes, by position
+    bool columnarScans; // Full scans read columns instead of Showtime objects
     int nextShowtimeId;
     int nextAuditoriumId;
+    const Clock& timeSource; // What "in the past" means when scheduling
+    function<void(const Auditorium&)> auditoriumListener; // Notified when an auditorium is created
+    function<void(const Showtime&)> showtimeListener; // Notified when a showtime is created or rescheduled
+    // Booking threads record seat sales while the menu reads and schedules; listeners are called under it
+    mutable recursive_mutex showtimesMutex;
     
+    static const int CLEANING_BUFFER_SECONDS = 30 * 60; // Between two showtimes in one auditorium
+    
+    void indexShowtime(size_t position);
+    void unindexShowtime(size_t position);
+    void rankShowtime(size_t position);
+    void unrankShowtime(size_t position);
+    vector<Showtime> getShowtimesInRange(time_t fromTime, time_t toTime, int status = -1, 
+                                         int auditoriumId = 0) const; // status: ShowtimeStatus or -1 for any
+    void commitShowtimes(vector<Showtime>& newShowtimes);
     bool validateShowtime(const Showtime& showtime) const;
     bool checkTimeConflict(int auditoriumId, time_t startTime, time_t endTime, int excludeShowtimeId = -1) const;
     vector<Showtime> heapSortShowtimes(vector<Showtime> showtimeList, bool byTime = true) const;
 
 public:
-    ShowtimeService();
+    explicit ShowtimeService(const Clock& clock = TimeService::systemClock());
+    
+    // Listeners (e.g. BookingService keeps seat maps in sync)
+    void setAuditoriumListener(const function<void(const Auditorium&)>& listener) { auditoriumListener = listener; }
+    void setShowtimeListener(const function<void(const Showtime&)>& listener) { showtimeListener = listener; }
+    
+    // Full scans in filterShowtimes and searchShowtimes use the columnar store (on by default)
+    void setColumnarScans(bool enabled) { columnarScans = enabled; }
+    bool isColumnarScans() const { return columnarScans; }
     
     // Auditorium management
     bool createAuditorium(const Auditorium& auditorium);
@@ -116,27 +259,46 @@ public:
     vector<Auditorium> getAllAuditoriums() const;
     
     // Showtime CRUD operations
+    // Auditorium, times, status and seat counts are indexed; change them through updateShowtime,
+    // cancelShowtime or updateSeatsAvailable only
     bool createShowtime(const Showtime& showtime);
     bool updateShowtime(int showtimeId, const Showtime& updatedShowtime);
     bool cancelShowtime(int showtimeId, const string& reason = "");
+    // The row is read outside the lock, so a concurrent sale can change its seats_available
     Showtime* findShowtimeById(int showtimeId);
-    vector<Showtime> searchShowtimes(const string& query) const;
+    const Showtime* findShowtimeById(int showtimeId) const;
+    bool updateSeatsAvailable(int showtimeId, int seatsAvailable); // Keeps the occupancy ranking current
+    bool recordSeatSales(int showtimeId, int soldDelta); // Seats sold (or freed when negative), from any thread
+    vector<Showtime> searchShowtimes(const string& query, const atomic<bool>* canceled = nullptr) const; // Stops early once *canceled is set
     vector<Showtime> filterShowtimes(const string& status = "", int auditoriumId = 0, 
-                                   time_t fromDate = 0, time_t toDate = 0) const;
+                                   time_t fromDate = 0, time_t toDate = 0) const; // Status name, empty for any
     
     // Bulk operations
     bool bulkCreateShowtimes(const vector<Showtime>& showtimeList);
-    bool copySchedule(time_t fromDate, time_t toDate);
+    bool copySchedule(time_t fromDate, time_t toDate); // fromDate's whole day onto toDate's day
+    // Copies showtimes starting in [fromTime, toTime) dayOffset days later at the same local time: all rows or none
+    bool copyScheduleRange(time_t fromTime, time_t toTime, int dayOffset, vector<ScheduleConflict>& conflicts);
+    
+    // Scheduler: packs the demands into the auditoriums between openTime and closeTime around existing
+    // showtimes (greedy placement, then local search). placedCounts[i] is the number of shows for demands[i]
+    vector<Showtime> planSchedule(const vector<ShowtimeDemand>& demands, time_t openTime, time_t closeTime, 
+                                  vector<int>& placedCounts) const;
+    bool autoSchedule(const vector<ShowtimeDemand>& demands, time_t openTime, time_t closeTime);
     
-    // Conflict checking
+    // Conflict checking (includes the cleaning buffer, ignores canceled showtimes)
     bool hasConflict(int auditoriumId, time_t startTime, time_t endTime) const;
     vector<Showtime> getConflictingShowtimes(int auditoriumId, time_t startTime, time_t endTime) const;
     
     // Statistics and reporting
-    vector<Showtime> getShowtimesByDate(time_t date) const;
+    vector<Showtime> getShowtimesByDate(time_t date, const string& status = "", int auditoriumId = 0) const;
     vector<Showtime> getShowtimesByAuditorium(int auditoriumId) const;
-    double getAverageOccupancyRate() const;
-    vector<Showtime> getTopPerformingShowtimes(int limit = 10) const;
+    double getAverageOccupancyRate() const; // O(1) from the running totals
+    OccupancyStats getOccupancyStats() const;
+    OccupancyStats getAuditoriumOccupancy(int auditoriumId) const;
+    OccupancyStats getDailyOccupancy(time_t date) const;
+    vector<Showtime> getTopPerformingShowtimes(int limit = 10) const; // O(limit) from the occupancy ranking
+    // Earliest showtimes of any of the versions starting at or after fromTime, canceled ones skipped
+    vector<Showtime> getUpcomingShowtimes(const vector<int>& movieVersionIds, time_t fromTime, size_t limit) const;
     
     // Demo functions for terminal UI
     void createShowtimeDemo();
@@ -145,6 +307,9 @@ public:
     void searchShowtimesDemo();
     void bulkCreateDemo();
     void copyScheduleDemo();
+    void autoScheduleDemo();
+    void schedulerBenchmarkDemo();
+    void columnarScanBenchmarkDemo();
     
     // Utility
     void displayAllShowtimes() const;
@@ -0,0 +1,153 @@
+#include "TimeService.h"
+#include <map>
+#include <mutex>
+#include <cstdio>
+
+static const int MAX_CACHED_DAYS = 4096;
+
+static mutex daysMutex;
+static map<time_t, LocalDay> days; // start -> day
+
+static void toLocalTime(time_t timeValue, struct tm& result) {
+#ifdef _WIN32
+    localtime_s(&result, &timeValue);
+#else
+    localtime_r(&timeValue, &result);
+#endif
+}
+
+// The only place a day is worked out with the C library
+static LocalDay computeDay(time_t timeValue) {
+    struct tm dateInfo;
+    toLocalTime(timeValue, dateInfo);
+    
+    LocalDay day;
+    day.key = (dateInfo.tm_year + 1900) * 10000 + (dateInfo.tm_mon + 1) * 100 + dateInfo.tm_mday;
+    dateInfo.tm_hour = 0;
+    dateInfo.tm_min = 0;
+    dateInfo.tm_sec = 0;
+    dateInfo.tm_isdst = -1;
+    day.start = mktime(&dateInfo);
+    dateInfo.tm_mday++;
+    dateInfo.tm_isdst = -1;
+    day.end = mktime(&dateInfo);
+    return day;
+}
+
+static void putDigits(char* out, int value, int digits) {
+    for (int i = digits - 1; i >= 0; i--) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+}
+
+time_t TimeService::now() {
+    return time(0);
+}
+
+const Clock& TimeService::systemClock() {
+    static const SystemClock clock;
+    return clock;
+}
+
+LocalDay TimeService::getDay(time_t timeValue) {
+    // Most lookups hit the day the thread looked up last
+    static thread_local LocalDay lastDay = {1, 0, 0};
+    if (timeValue >= lastDay.start && timeValue < lastDay.end) {
+        return lastDay;
+    }
+    
+    lock_guard<mutex> guard(daysMutex);
+    auto it = days.upper_bound(timeValue);
+    if (it != days.begin() && timeValue < (--it)->second.end) {
+        lastDay = it->second;
+        return lastDay;
+    }
+    
+    LocalDay day = computeDay(timeValue);
+    if ((int)days.size() >= MAX_CACHED_DAYS) {
+        days.clear();
+    }
+    days[day.start] = day;
+    lastDay = day;
+    return day;
+}
+
+time_t TimeService::addDays(time_t timeValue, int dayCount) {
+    struct tm dateInfo;
+    toLocalTime(timeValue, dateInfo);
+    dateInfo.tm_mday += dayCount;
+    dateInfo.tm_isdst = -1;
+    return mktime(&dateInfo);
+}
+
+int TimeService::daysBetween(time_t fromTime, time_t toTime) {
+    // Local days are 23 to 25 hours long, so rounding the difference of day starts is exact
+    double seconds = difftime(getDay(toTime).start, getDay(fromTime).start);
+    return (int)(seconds >= 0 ? (seconds + 43200) / 86400 : (seconds - 43200) / 86400);
+}
+
+bool TimeService::parseDate(const string& date, time_t& dayStartTime) {
+    int year, month, dayOfMonth;
+    char extra;
+    if (sscanf(date.c_str(), "%d-%d-%d%c", &year, &month, &dayOfMonth, &extra) != 3 ||
+        month < 1 || month > 12 || dayOfMonth < 1 || dayOfMonth > 31) {
+        return false;
+    }
+    
+    struct tm dateInfo = {};
+    dateInfo.tm_year = year - 1900;
+    dateInfo.tm_mon = month - 1;
+    dateInfo.tm_mday = dayOfMonth;
+    dateInfo.tm_hour = 12; // Noon is on the right day even when midnight is skipped
+    dateInfo.tm_isdst = -1;
+    time_t noon = mktime(&dateInfo);
+    if (noon == (time_t)-1) {
+        return false;
+    }
+    LocalDay day = getDay(noon);
+    if (day.key != year * 10000 + month * 100 + dayOfMonth) {
+        return false; // e.g. 2024-02-31
+    }
+    dayStartTime = day.start;
+    return true;
+}
+
+string TimeService::formatDate(time_t timeValue) {
+    int key = getDay(timeValue).key;
+    char buffer[10];
+    putDigits(buffer, key / 10000, 4);
+    buffer[4] = '-';
+    putDigits(buffer + 5, key / 100 % 100, 2);
+    buffer[7] = '-';
+    putDigits(buffer + 8, key % 100, 2);
+    return string(buffer, sizeof(buffer));
+}
+
+string TimeService::formatDateTime(time_t timeValue) {
+    LocalDay day = getDay(timeValue);
+    int hour, minute;
+    if (day.end - day.start == 24 * 3600) {
+        long seconds = (long)(timeValue - day.start);
+        hour = (int)(seconds / 3600);
+        minute = (int)(seconds % 3600 / 60);
+    } else {
+        // DST change: the wall clock jumps during this day
+        struct tm timeInfo;
+        toLocalTime(timeValue, timeInfo);
+        hour = timeInfo.tm_hour;
+        minute = timeInfo.tm_min;
+    }
+    
+    char buffer[16];
+    putDigits(buffer, day.key / 10000, 4);
+    buffer[4] = '-';
+    putDigits(buffer + 5, day.key / 100 % 100, 2);
+    buffer[7] = '-';
+    putDigits(buffer + 8, day.key % 100, 2);
+    buffer[10] = ' ';
+    putDigits(buffer + 11, hour, 2);
+    buffer[13] = ':';
+    putDigits(buffer + 14, minute, 2);
+    return string(buffer, sizeof(buffer));
+}
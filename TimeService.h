@@ -0,0 +1,65 @@
+#ifndef TIMESERVICE_H
+#define TIMESERVICE_H
+
+#include <string>
+#include <ctime>
+#include <atomic>
+
+using namespace std;
+
+// LocalDay struct - one local calendar day [start, end), 23 or 25 hours long on DST changes
+struct LocalDay {
+    time_t start;
+    time_t end;
+    int key; // YYYYMMDD
+};
+
+// Clock - where the services read the current time from
+class Clock {
+public:
+    virtual ~Clock() {}
+    virtual time_t now() const = 0;
+};
+
+// SystemClock - the wall clock
+class SystemClock : public Clock {
+public:
+    time_t now() const override { return time(0); }
+};
+
+// SimulatedClock - stands still until advanced, for replaying traffic faster than real time
+class SimulatedClock : public Clock {
+private:
+    atomic<long long> current_time;
+
+public:
+    explicit SimulatedClock(time_t startTime) : current_time(startTime) {}
+    
+    time_t now() const override { return (time_t)current_time.load(); }
+    void setTime(time_t timeValue) { current_time.store(timeValue); }
+    void advance(int seconds) { current_time.fetch_add(seconds); }
+};
+
+// TimeService - local time helpers shared by all services
+// Local day boundaries are computed once per day and cached, so day starts, day keys and
+// formatting are arithmetic on a cached day instead of localtime/mktime/strftime per call.
+class TimeService {
+public:
+    // Entities stamp times with the wall clock; services take a Clock, this one unless told otherwise
+    static time_t now();
+    static const Clock& systemClock();
+
+    static LocalDay getDay(time_t timeValue);
+    static time_t dayStart(time_t timeValue) { return getDay(timeValue).start; }
+    static int dayKey(time_t timeValue) { return getDay(timeValue).key; }
+    static time_t addDays(time_t timeValue, int dayCount); // Same local clock time, across DST changes
+    static int daysBetween(time_t fromTime, time_t toTime); // Local days from fromTime's day to toTime's
+
+    // "YYYY-MM-DD" to the start of that local day; false if the text is not a date
+    static bool parseDate(const string& date, time_t& dayStartTime);
+
+    static string formatDate(time_t timeValue); // YYYY-MM-DD
+    static string formatDateTime(time_t timeValue); // YYYY-MM-DD HH:MM
+};
+
+#endif
@@ -19,7 +19,29 @@ private:
     
 public:
     CinemaSystem()
-            : searchService(&movieService, &showtimeService, &bookingService, &paymentService) {}
+            : searchService(&movieService, &showtimeService, &bookingService, &paymentService) {
+        // Seat maps follow the auditoriums and scheduled showtimes (layout and hold timeout)
+        for (const auto& auditorium : showtimeService.getAllAuditoriums()) {
+            bookingService.registerAuditorium(auditorium);
+        }
+        // Occupancy starts from the seat maps; replaying the booking log below brings both up to date
+        for (const auto& showtime : showtimeService.filterShowtimes()) {
+            bookingService.registerShowtime(showtime);
+            showtimeService.updateSeatsAvailable(showtime.getId(), bookingService.getAvailableSeatCount(showtime.getId()));
+        }
+        
+        showtimeService.setAuditoriumListener([this](const Auditorium& auditorium) {
+            bookingService.registerAuditorium(auditorium);
+        });
+        showtimeService.setShowtimeListener([this](const Showtime& showtime) {
+            bookingService.registerShowtime(showtime);
+        });
+        bookingService.setSoldSeatsListener([this](int showtimeId, int soldDelta) {
+            showtimeService.recordSeatSales(showtimeId, soldDelta);
+            searchService.recordSeatSales(showtimeId, soldDelta); // Ranks title suggestions by tickets sold
+        });
+        bookingService.openLog("booking.wal"); // Recovers bookings made before a crash, occupancy included
+    }
     void displayMainMenu() {
         cout << "\n=== CINEMA BOOKING SYSTEM ===" << endl;
         cout << "1. Movie Management" << endl;
@@ -39,6 +61,19 @@ public:
         cout << "4. Archive Movie" << endl;
         cout << "5. Bulk Import Movies" << endl;
         cout << "6. Movie Statistics" << endl;
+        cout << "7. Search Index Benchmark" << endl;
+        cout << "8. Fuzzy Match Benchmark" << endl;
+        cout << "9. Facet Filter Benchmark" << endl;
+        cout << "0. Back to Main Menu" << endl;
+        cout << "Choose option: ";
+    }
+    
+    void displaySearchMenu() {
+        cout << "\n=== SEARCH FUNCTIONS ===" << endl;
+        cout << "1. Search All" << endl;
+        cout << "2. Title Autocomplete" << endl;
+        cout << "3. Autocomplete Benchmark" << endl;
+        cout << "4. Federated Search Benchmark" << endl;
         cout << "0. Back to Main Menu" << endl;
         cout << "Choose option: ";
     }
@@ -51,6 +86,9 @@ public:
         cout << "4. Search Showtimes" << endl;
         cout << "5. Bulk Create Showtimes" << endl;
         cout << "6. Copy Schedule" << endl;
+        cout << "7. Auto Schedule Tomorrow" << endl;
+        cout << "8. Scheduler Benchmark" << endl;
+        cout << "9. Columnar Scan Benchmark" << endl;
         cout << "0. Back to Main Menu" << endl;
         cout << "Choose option: ";
     }
@@ -65,6 +103,11 @@ public:
         cout << "6. Print Ticket" << endl;
         cout << "7. Exchange Ticket" << endl;
         cout << "8. Refund Ticket" << endl;
+        cout << "9. Concurrent Booking Stress Test" << endl;
+        cout << "10. Seat Map Compiler Benchmark" << endl;
+        cout << "11. Booking Log Benchmark" << endl;
+        cout << "12. Status Encoding Benchmark" << endl;
+        cout << "13. Box Office Traffic Replay" << endl;
         cout << "0. Back to Main Menu" << endl;
         cout << "Choose option: ";
     }
@@ -126,6 +169,15 @@ private:
                 case 6:
                     movieService.showStatisticsDemo();
                     break;
+                case 7:
+                    movieService.searchIndexBenchmarkDemo();
+                    break;
+                case 8:
+                    movieService.fuzzyMatchBenchmarkDemo();
+                    break;
+                case 9:
+                    movieService.facetFilterBenchmarkDemo();
+                    break;
                 case 0:
                     return;
                 default:
@@ -153,6 +205,21 @@ private:
                 case 4:
                     showtimeService.searchShowtimesDemo();
                     break;
+                case 5:
+                    showtimeService.bulkCreateDemo();
+                    break;
+                case 6:
+                    showtimeService.copyScheduleDemo();
+                    break;
+                case 7:
+                    showtimeService.autoScheduleDemo();
+                    break;
+                case 8:
+                    showtimeService.schedulerBenchmarkDemo();
+                    break;
+                case 9:
+                    showtimeService.columnarScanBenchmarkDemo();
+                    break;
                 case 0:
                     return;
                 default:
@@ -186,6 +253,21 @@ private:
                 case 6:
                     bookingService.printTicketDemo();
                     break;
+                case 9:
+                    bookingService.concurrentBookingDemo();
+                    break;
+                case 10:
+                    bookingService.seatMapBenchmarkDemo();
+                    break;
+                case 11:
+                    bookingService.bookingLogBenchmarkDemo();
+                    break;
+                case 12:
+                    bookingService.statusEncodingBenchmarkDemo();
+                    break;
+                case 13:
+                    bookingService.trafficReplayDemo();
+                    break;
                 case 0:
                     return;
                 default:
@@ -195,8 +277,30 @@ private:
     }
     
     void handleSearchFunctions() {
-        cout << "\n=== SEARCH FUNCTIONS ===" << endl;
-        searchService.demonstrateSearch();
+        int choice;
+        do {
+            displaySearchMenu();
+            cin >> choice;
+            
+            switch(choice) {
+                case 1:
+                    searchService.demonstrateSearch();
+                    break;
+                case 2:
+                    searchService.autocompleteDemo();
+                    break;
+                case 3:
+                    searchService.autocompleteBenchmarkDemo();
+                    break;
+                case 4:
+                    searchService.federatedSearchBenchmarkDemo();
+                    break;
+                case 0:
+                    return;
+                default:
+                    cout << "Invalid option!" << endl;
+            }
+        } while(choice != 0);
     }
     
     void handleQuickLookup() {
@@ -214,7 +318,35 @@ private:
     }
 };
 
-int main() {
+// Correctness checks, for scripts: "cinema --self-check" exits non-zero if any check fails
+static bool runSelfChecks() {
+    struct SelfCheck {
+        const char* name;
+        bool (*run)();
+    };
+    const SelfCheck checks[] = {
+        {"concurrent seat holds", &BookingService::concurrentHoldCheck},
+        {"concurrent orders", &BookingService::concurrentSalesCheck},
+        {"booking log replay", &BookingService::logReplayCheck},
+        {"fuzzy title matching", &MovieService::fuzzyMatchCheck},
+        {"facet bitmaps", &MovieService::facetBitmapCheck},
+    };
+    
+    int failed = 0;
+    for (const SelfCheck& check : checks) {
+        bool passed = check.run();
+        cout << (passed ? "PASS " : "FAIL ") << check.name << endl;
+        failed += passed ? 0 : 1;
+    }
+    cout << failed << " of " << sizeof(checks) / sizeof(checks[0]) << " checks failed" << endl;
+    return failed == 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--self-check") {
+        return runSelfChecks() ? 0 : 1;
+    }
+    
     CinemaSystem system;
     system.run();
     return 0;